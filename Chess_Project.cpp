@@ -5,36 +5,186 @@
 
 #include <iostream>
 #include <cstdlib>
-#include <cmath>
+#include <fstream>
+#include <thread>
 #include "legal_moves.h"
+#include "magics.h"
+#include "perft.h"
+#include "search.h"
+#include "transposition_table.h"
+#include "uci.h"
+#include "epd_analysis.h"
+#include "selfplay.h"
+#include "fen.h"
+#include "book.h"
 
 #define ISWHITEMOVE (moveNum%2 == 1)
 #define ISBLACKMOVE (moveNum%2 == 0)
-#define ISFORWHITE (isCompMove == compIsWhite)
-#define ISFORBLACK (isCompMove != compIsWhite)
 
 using namespace std;
 
 // Declare functions
-ply findBestMove (bitboard bBoard, int depth, bool compIsWhite);
-int alphabeta (bitboard bBoard, int depth, int alpha, int beta, bool isCompMove, bool compIsWhite);
-int calcBoardVal (bitboard bBoard, bool forWhite);
-int calcLocVal (int square);
-string enterUserMove (bitboard bBoard, svec sBoard, int moveNum);
+void playGame ();
+string enterUserMove (const bitboard &bBoard, svec sBoard, int moveNum);
 
-int main()
+int main(int argc, char *argv[])
 {
     // Allow user to play chess
     //twoPlayerGame();
 
-    // Initialize the arrays, the bitboard, the vector, variables etc.
-    getDirections();
+    // Initialize the arrays and the hash table
+    initMagics();
+    setHashSize(16);
+
+    // Run perft from a position (the starting position if no FEN is given) if asked to
+    // Usage: perft <depth> [threads] [hash size in MB] [FEN]
+    if (argc >= 3 && string(argv[1]) == "perft")
+    {
+        bitboard bBoard;
+        bool whiteMove;
+        string fen = STARTFEN;
+
+        // The fields of the FEN can be given as one argument or as several
+        if (argc >= 6)
+        {
+            fen = argv[5];
+            for (int i = 6; i < argc; i++)
+                fen += string(" ") + argv[i];
+        }
+
+        if (!parseFen(bBoard, whiteMove, fen.c_str()))
+        {
+            cerr << "Invalid FEN: " << fen << endl;
+            return 1;
+        }
+
+        int depth = atoi(argv[2]);
+        int numThreads = (argc >= 4) ? atoi(argv[3]) : 1;
+        int hashMB = (argc >= 5) ? atoi(argv[4]) : 0;
+
+        perftDivide(bBoard, depth, whiteMove, max(numThreads, 1), hashMB);
+        return 0;
+    }
+
+    // Analyse every position in an EPD file (- for the standard input), writing a JSON line for each one
+    // Usage: analyze <EPD file> <depth> [threads] [hash size in MB per thread]
+    if (argc >= 4 && string(argv[1]) == "analyze")
+    {
+        searchLimits limits;
+        limits.depth = max(atoi(argv[3]), 1);
+        int numThreads = (argc >= 5) ? atoi(argv[4]) : (int)thread::hardware_concurrency();
+        int hashMB = (argc >= 6) ? atoi(argv[5]) : 16;
+
+        ifstream file;
+        if (string(argv[2]) != "-")
+        {
+            file.open(argv[2]);
+            if (!file)
+            {
+                cerr << "Could not open " << argv[2] << endl;
+                return 1;
+            }
+        }
+
+        int numAnalysed = analyzeEpd(file.is_open() ? file : cin, cout, limits, max(numThreads, 1), hashMB);
+        cerr << numAnalysed << " positions analysed" << endl;
+        return 0;
+    }
+
+    // Play a match between two engines with different search limits (e.g. nodes=5000 or movetime=50) from a file
+    // of opening FENs, or from the starting position
+    // Usage: selfplay <openings file|startpos> <games> <engine A limits> <engine B limits> [threads]
+    //        [hash size in MB per engine per thread]
+    if (argc >= 6 && string(argv[1]) == "selfplay")
+    {
+        searchLimits limitsA, limitsB;
+        if (!parseLimits(argv[4], limitsA) || !parseLimits(argv[5], limitsB))
+        {
+            cerr << "Limits should look like depth=6, nodes=5000 or movetime=50 (separated by commas)" << endl;
+            return 1;
+        }
+
+        int numThreads = (argc >= 7) ? atoi(argv[6]) : (int)thread::hardware_concurrency();
+        int hashMB = (argc >= 8) ? atoi(argv[7]) : 16;
+
+        // Read the openings, one FEN per line
+        vector <string> openings;
+        if (string(argv[2]) == "startpos")
+            openings.push_back(STARTFEN);
+        else
+        {
+            ifstream file(argv[2]);
+            string line;
+            if (!file)
+            {
+                cerr << "Could not open " << argv[2] << endl;
+                return 1;
+            }
+
+            while (getline(file, line))
+            {
+                if (!line.empty() && line[0] != '#' && line.find_first_not_of(" \t\r") != string::npos)
+                    openings.push_back(line);
+            }
+        }
+
+        playMatch(openings, atoi(argv[3]), limitsA, limitsB, max(numThreads, 1), hashMB, cout);
+        return 0;
+    }
+
+    // Make an opening book from the games in a PGN file
+    // Usage: makebook <PGN file> <book file> [plies per game]
+    if (argc >= 4 && string(argv[1]) == "makebook")
+    {
+        ifstream pgn(argv[2]);
+        if (!pgn)
+        {
+            cerr << "Could not open " << argv[2] << endl;
+            return 1;
+        }
+
+        int numGames = buildBook(pgn, argv[3], (argc >= 5) ? atoi(argv[4]) : BOOKMAXPLY);
+        if (numGames < 0)
+        {
+            cerr << "Could not write " << argv[3] << endl;
+            return 1;
+        }
+
+        cout << numGames << " games added to " << argv[3] << endl;
+        return 0;
+    }
+
+    // Play against the computer in the console if asked to (using an opening book if one is given),
+    // otherwise talk to a GUI over UCI
+    // Usage: play [book file]
+    if (argc >= 2 && string(argv[1]) == "play")
+    {
+        if (argc >= 3 && !openBook(argv[2]))
+            cerr << "Could not open " << argv[2] << endl;
+        playGame();
+    }
+    else
+        uciLoop();
+
+    // Finish program
+    return 0;
+}
+
+// Function to play a game against the computer in the console
+void playGame ()
+{
+    // Initialize the bitboard, the vector, variables etc.
     bitboard bBoard;
     svec sBoard;
-    plyvec legalMoves;
     string input;
+    ply move;
+    undo u;
     int moveNum = 1, curr = 0, dest = 0;
     bool compIsWhite = true;
+    searchInfo info;
+
+    // Give the computer a second to think about each move
+    info.limits.moveTime = 1000;
 
     // Initialise boards
     initBoard(sBoard);
@@ -47,9 +197,9 @@ int main()
         if (compIsWhite && ISWHITEMOVE)
         {
             // Calculate move
-            ply compMove = findBestMove(bBoard, 3, compIsWhite);
-            curr = compMove.curr;
-            dest = compMove.dest;
+            move = findBestMove(bBoard, compIsWhite, info);
+            curr = plyCurr(move);
+            dest = plyDest(move);
 
             // Output what move the AI chose
             //cout << curr << " " << dest << endl;
@@ -65,21 +215,29 @@ int main()
                 break;
 
             stringToSquare(input, curr, dest);
+
+            // Ask what to promote to if a pawn reaches the last row
+            char promotion = 'q';
+            if (((bBoard.wPawns | bBoard.bPawns) & sqrVal[curr]) && (dest/8 == 0 || dest/8 == 7))
+                promotion = getPromotionPiece()[0];
+
+            move = squaresToPly(bBoard, curr, dest, promotion);
         }
 
         // Update the bitboard, the string vector, and the number of moves
-        bBoard = updateBitboard(bBoard, curr, dest, false);
+        makeMove(bBoard, move, u);
         bitBoardToSVec(bBoard, sBoard);
         moveNum++;
 
         // Check for checkmate or stalemate
-        if (!areLegalMoves(bBoard, ISWHITEMOVE))
+        int result = getGameResult(bBoard, ISWHITEMOVE);
+        if (result != NORESULT)
         {
             displayBoard(sBoard);
 
-            if ((ISWHITEMOVE && isInCheck(bBoard, getWKingLoc(bBoard))))
+            if (result == BLACKWINS)
                 cout << "Checkmate! Black wins!" << endl;
-            else if ((ISBLACKMOVE && isInCheck(bBoard, getBKingLoc(bBoard))))
+            else if (result == WHITEWINS)
                 cout << "Checkmate! White wins!" << endl;
             else
                 cout << "Draw from stalemate." << endl;
@@ -92,194 +250,10 @@ int main()
     string s;
     cout << "Enter anything to close: ";
     cin >> s;
-
-    // Finish program
-    return 0;
-}
-
-// Function to call alpha-beta to find the best move for the computer
-ply findBestMove (bitboard bBoard, int depth, bool compIsWhite)
-{
-    // Get all the moves available for the computer
-    plyvec legalMoves = getLegalMoves(bBoard, compIsWhite);
-    int bestVal, bestMove = 0;
-
-    // Go through all the legal moves of the computer
-    for (unsigned int i = 0; i < legalMoves.size(); i++)
-    {
-        // Update the bitboard after a move
-        bitboard bb2 = updateBitboard(bBoard, legalMoves[i].curr, legalMoves[i].dest, true);
-
-        // Check for checkmate/stalemate
-        if (compIsWhite && !areLegalMoves(bb2, false) && isInCheck(bb2, getBKingLoc(bb2)))
-            return legalMoves[i];
-        if (!compIsWhite && !areLegalMoves(bb2, true) && isInCheck(bb2, getWKingLoc(bb2)))
-            return legalMoves[i];
-
-        // Call the alpha-beta algorithm to evaluate the position at hand
-        int alpha = -2000000000, beta = 2000000000;
-        int boardVal = alphabeta(bb2, depth-1, alpha, beta, false, compIsWhite);
-
-        // Update the best move and the best value
-        if (i == 0 || boardVal > bestVal)
-        {
-            bestVal = boardVal;
-            bestMove = i;
-        }
-    }
-
-    //cout << "Computer value is: " << bestVal << endl;
-    return legalMoves[bestMove];
-}
-
-// Function that uses the recursive alpha-beta algorithm to return the value of an updated bitboard
-int alphabeta (bitboard bBoard, int depth, int alpha, int beta, bool isCompMove, bool compIsWhite)
-{
-    // Get all the legal moves for whoever is supposed to move
-    plyvec legalMoves = getLegalMoves(bBoard, ISFORWHITE);
-
-    // Stop search if there are no more legal moves or if the search has reached the maximum depth
-    if (legalMoves.size() == 0 || depth == 0)
-    {
-        return calcBoardVal(bBoard, compIsWhite);
-    }
-
-    // Maximize the value if it is the computer's turn to move
-    if (isCompMove)
-    {
-        int bestVal = 0;
-
-        // Go through all the legal moves, searching for the move that is worst for the computer
-        for (unsigned int i = 0; i < legalMoves.size(); i++)
-        {
-            // Update bitboard and recursively call the alpha-beta algorithm
-            bitboard bBoard2 = updateBitboard(bBoard, legalMoves[i].curr, legalMoves[i].dest, true);
-            int boardVal = alphabeta(bBoard2, depth-1, alpha, beta, !isCompMove, compIsWhite);
-
-            // Update the best board value and alpha, the best position the computer is guaranteed of
-            if (i == 0 || boardVal > bestVal)
-                bestVal = boardVal;
-            if (bestVal > alpha)
-                alpha = bestVal;
-
-            // Stop if the move is worse than all the previous moves
-            if (beta <= alpha)
-                break;
-        }
-
-        return bestVal;
-    }
-    // Minimize the board's value if it is the opponent's turn to move
-    else
-    {
-        int bestVal = 0;
-
-        // Go through all the legal moves, searching for the move that is worst for the computer
-        for (unsigned int i = 0; i < legalMoves.size(); i++)
-        {
-            // Update bitboard and recursively call the alpha-beta algorithm
-            bitboard bBoard2 = updateBitboard(bBoard, legalMoves[i].curr, legalMoves[i].dest, true);
-            int boardVal = alphabeta(bBoard2, depth-1, alpha, beta, !isCompMove, compIsWhite);
-
-            // Update the best board value and beta, the best position the user is guaranteed of
-            if (i == 0 || boardVal < bestVal)
-                bestVal = boardVal;
-            if (bestVal < beta)
-                beta = bestVal;
-
-            // Stop if the move is worse than all the previous moves
-            if (beta <= alpha)
-                break;
-        }
-
-        return bestVal;
-    }
-}
-
-// Function to return the value of a board for a side
-int calcBoardVal (bitboard bBoard, bool forWhite)
-{
-    int wPositionVal = 0, bPositionVal = 0;
-
-    // Return a million points if checkmate is achieved
-    if (forWhite && !areLegalMoves(bBoard, true) && isInCheck(bBoard, getWKingLoc(bBoard)))
-        return -1000000;
-    if (forWhite && !areLegalMoves(bBoard, false) && isInCheck(bBoard, getBKingLoc(bBoard)))
-        return 1000000;
-    if (!forWhite && !areLegalMoves(bBoard, false) && isInCheck(bBoard, getBKingLoc(bBoard)))
-        return -1000000;
-    if (!forWhite && !areLegalMoves(bBoard, true) && isInCheck(bBoard, getWKingLoc(bBoard)))
-        return 1000000;
-
-    // During the opening, give points for a minor pieces and pawns closer to the centre of the board
-    if (bBoard.wMaterialVal + bBoard.bMaterialVal < 6000)
-    {
-        U64 wGoodPieces = bBoard.wPawns | bBoard.wKnights | bBoard.wBishops;
-        U64 bGoodPieces = bBoard.bPawns | bBoard.bKnights | bBoard.bBishops;
-        U64 wBadPieces = bBoard.wRooks | bBoard.wQueens;
-        U64 bBadPieces = bBoard.bRooks | bBoard.bQueens;
-
-        // Go through all the squares determining where all the pieces are
-        for (int i = 0; i < 64; i++)
-        {
-            if (wGoodPieces & sqrVal[i])
-                wPositionVal += 2*calcLocVal(i);
-            if (bGoodPieces & sqrVal[i])
-                bPositionVal += 2*calcLocVal(i);
-            if (wBadPieces & sqrVal[i])
-                wPositionVal -= 5*calcLocVal(i);
-            if (bBadPieces & sqrVal[i])
-                bPositionVal -= 5*calcLocVal(i);
-        }
-    }
-    // Otherwise just give points for any piece closer to the centre of the board
-    else
-    {
-        // Go through all the squares determining where all the pieces are
-        for (int i = 0; i < 64; i++)
-        {
-            if (bBoard.wPieces & sqrVal[i])
-                wPositionVal += calcLocVal(i);
-            if (bBoard.bPieces & sqrVal[i])
-                bPositionVal += calcLocVal(i);
-        }
-    }
-
-    // Return the board value and add material value
-    if (forWhite)
-        return (bBoard.wMaterialVal-bBoard.bMaterialVal) + (wPositionVal-bPositionVal);
-    else
-        return (bBoard.bMaterialVal-bBoard.wMaterialVal) + (bPositionVal-wPositionVal);
-}
-
-// Calculate the value of a piece located on a particular square (centre is better)
-int calcLocVal (int square)
-{
-    // The values are as follows:
-    //
-    // -10 -10 -10 -10 -10 -10 -10 -10
-    // -10   0   0   0   0   0   0 -10
-    // -10   0  10  10  10  10   0 -10
-    // -10   0  10  20  20  10   0 -10
-    // -10   0  10  20  20  10   0 -10
-    // -10   0  10  10  10  10   0 -10
-    // -10   0   0   0   0   0   0 -10
-    // -10 -10 -10 -10 -10 -10 -10 -10
-    //
-
-    // Determine which concentric box the square is a part of
-    if (square/8 == 0 || square/8 == 7 || square%8 == 0 || square%8 == 7)
-        return -10;
-    else if (square/8 == 1 || square/8 == 6 || square%8 == 1 || square%8 == 6)
-        return 0;
-    else if (square/8 == 2 || square/8 == 5 || square%8 == 2 || square%8 == 5)
-        return 10;
-    else
-        return 20;
 }
 
 // Function to allow the user to enter in a move
-string enterUserMove (bitboard bBoard, svec sBoard, int moveNum)
+string enterUserMove (const bitboard &bBoard, svec sBoard, int moveNum)
 {
     string input;
     int curr = 0, dest = 0;
@@ -330,9 +304,9 @@ string enterUserMove (bitboard bBoard, svec sBoard, int moveNum)
             bitboard bb2 = updateBitboard(bBoard, curr, dest, true);;
 
             // Check if it is because of check
-            if (isInCheck(bb2, 63-log2(bb2.wKings)))
+            if (isInCheck(bb2, getWKingLoc(bb2)))
                 cout << "White king is in check" << endl;
-            if (isInCheck(bb2, 63-log2(bb2.bKings)))
+            if (isInCheck(bb2, getBKingLoc(bb2)))
                 cout << "Black king is in check" << endl;
         }
     }
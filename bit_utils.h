@@ -0,0 +1,79 @@
+/// bit_utils.h
+///
+/// Willie Lei
+/// Bit-scan and population count functions for 64-bit integers.
+///
+/// Square 0 is the highest bit (see rowColVal in legal_moves.h), so the first square of a bitboard
+/// is found from its leading zeros, and popping squares visits them in the same order as counting
+/// from square 0 to 63 would.
+
+#ifndef BIT_UTILS_H_INCLUDED
+#define BIT_UTILS_H_INCLUDED
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+typedef unsigned long long U64;
+
+// Function to return the number of bits set in a 64-bit integer
+inline int popCount (U64 b)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_popcountll(b);
+#elif defined(_MSC_VER) && defined(_M_X64)
+    return (int)__popcnt64(b);
+#else
+    int count = 0;
+    for (; b; count++)
+        b &= b - 1;
+    return count;
+#endif
+}
+
+// Function to return the index of the highest bit set in a 64-bit integer (which must not be 0)
+inline int msb (U64 b)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return 63 - __builtin_clzll(b);
+#elif defined(_MSC_VER) && defined(_M_X64)
+    unsigned long index;
+    _BitScanReverse64(&index, b);
+    return (int)index;
+#else
+    int index = 0;
+    while (b >>= 1)
+        index++;
+    return index;
+#endif
+}
+
+// Function to return the index of the lowest bit set in a 64-bit integer (which must not be 0)
+inline int lsb (U64 b)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll(b);
+#elif defined(_MSC_VER) && defined(_M_X64)
+    unsigned long index;
+    _BitScanForward64(&index, b);
+    return (int)index;
+#else
+    return msb(b & (0 - b));
+#endif
+}
+
+// Function to return the first square (lowest numbered) in a bitboard, which must not be empty
+inline int firstSquare (U64 b)
+{
+    return 63 - msb(b);
+}
+
+// Function to remove the first square from a bitboard and return it
+inline int popSquare (U64 &b)
+{
+    int square = firstSquare(b);
+    b ^= 1ULL << (63 - square);
+    return square;
+}
+
+#endif // BIT_UTILS_H_INCLUDED
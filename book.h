@@ -0,0 +1,43 @@
+/// book.h
+///
+/// Willie Lei
+/// Header file for book.cpp
+
+#ifndef BOOK_H_INCLUDED
+#define BOOK_H_INCLUDED
+
+#include <iostream>
+#include <string>
+#include "legal_moves.h"
+
+// Size of an entry in a book file: the key (8 bytes), the move (2 bytes), the weight (2 bytes) and
+// the learn value (4 bytes, unused), all big-endian
+#define BOOKENTRYSIZE 16
+
+// Only the first BOOKMAXPLY plies of each game go into a book made from PGN
+#define BOOKMAXPLY 30
+
+// Functions to open a book file (memory-mapping it read-only) and to close it
+bool openBook (const string &fileName);
+void closeBook ();
+
+// Function to pick a move from the book for a position, at random in proportion to the weights of the moves,
+// returning 0 if the position isn't in the book
+ply probeBook (const bitboard &bBoard, bool whiteMove);
+
+// Function to make a book file from the games in a PGN file, returning the number of games read
+// Each move is weighted by 2 for a win and 1 for a draw for the side that played it
+int buildBook (istream &pgn, const string &fileName, int maxPly = BOOKMAXPLY);
+
+// Function to calculate the Polyglot hash key of a position, which books are keyed with
+U64 getPolyglotKey (const bitboard &bBoard, bool whiteMove);
+
+// Functions to convert between plies and moves as they are stored in books
+unsigned short plyToBookMove (ply move);
+ply bookMoveToPly (const bitboard &bBoard, bool whiteMove, unsigned short bookMove);
+
+// Function to turn a move in standard algebraic notation (e.g. Nbd7, exd5, O-O or e8=Q+) into a ply,
+// returning 0 if it isn't legal
+ply sanToPly (const bitboard &bBoard, bool whiteMove, const string &san);
+
+#endif // BOOK_H_INCLUDED
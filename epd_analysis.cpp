@@ -0,0 +1,189 @@
+/// epd_analysis.cpp
+///
+/// Willie Lei
+/// Batch analysis of EPD files, writing the results as newline-delimited JSON.
+///
+/// Each thread takes the next line from the file when it is free, so only one line per thread is held in memory
+/// however big the file is. Each thread has its own transposition table, which is emptied before every position,
+/// so the result of a position doesn't depend on which positions were analysed before it or on which thread.
+
+#include <algorithm>
+#include <thread>
+#include <mutex>
+#include <memory>
+#include <sstream>
+#include <cstdlib>
+#include <cstdio>
+#include "epd_analysis.h"
+#include "fen.h"
+
+using namespace std;
+
+// The input and output shared by the analysis threads, and the locks for taking turns with them
+struct epdBatch
+{
+    istream *in;
+    ostream *out;
+    searchLimits limits;
+    int hashMB;
+    int lineNum = 0;
+    int numAnalysed = 0;
+    mutex inLock;
+    mutex outLock;
+};
+
+// Function to write a string as a JSON string
+void writeJsonString (ostream &os, const string &s)
+{
+    os << '"';
+    for (unsigned int i = 0; i < s.size(); i++)
+    {
+        if (s[i] == '"' || s[i] == '\\')
+            os << '\\' << s[i];
+        else if ((unsigned char)s[i] < 32)
+        {
+            char escaped[8];
+            snprintf(escaped, sizeof(escaped), "\\u%04x", s[i]);
+            os << escaped;
+        }
+        else
+            os << s[i];
+    }
+    os << '"';
+}
+
+// Function to return the value of the id operation of an EPD line (empty if there isn't one)
+string getEpdId (const char *operations)
+{
+    string ops = operations;
+    size_t start = ops.find("id \"");
+
+    // Make sure "id" is a whole opcode and not the end of another word
+    while (start != string::npos && start > 0 && ops[start-1] != ' ' && ops[start-1] != ';')
+        start = ops.find("id \"", start + 1);
+    if (start == string::npos)
+        return "";
+
+    // Read up to the closing quote, leaving out the backslashes in front of escaped characters
+    string id;
+    for (size_t i = start + 4; i < ops.size() && ops[i] != '"'; i++)
+    {
+        if (ops[i] == '\\' && i + 1 < ops.size())
+            i++;
+        id += ops[i];
+    }
+
+    return id;
+}
+
+// Function to analyse one EPD line, returning its result as a JSON line
+string analyzeLine (const string &line, int lineNum, searchInfo &info)
+{
+    ostringstream os;
+    bitboard bBoard;
+    bool whiteMove;
+
+    os << "{\"line\":" << lineNum;
+
+    const char *operations = parseFen(bBoard, whiteMove, line.c_str());
+    if (!operations)
+    {
+        os << ",\"error\":\"invalid position\",\"input\":";
+        writeJsonString(os, line);
+        os << "}";
+        return os.str();
+    }
+
+    os << ",\"epd\":\"" << boardToEpd(bBoard, whiteMove) << "\"";
+    string id = getEpdId(operations);
+    if (!id.empty())
+    {
+        os << ",\"id\":";
+        writeJsonString(os, id);
+    }
+
+    // A position with no legal moves is already over, so there is nothing to search
+    plyList legalMoves;
+    getLegalMoves(bBoard, whiteMove, legalMoves);
+    if (legalMoves.size == 0)
+    {
+        bool inCheck = isInCheck(bBoard, whiteMove ? getWKingLoc(bBoard) : getBKingLoc(bBoard));
+        os << ",\"bestmove\":null,\"result\":\"" << (inCheck ? "checkmate" : "stalemate") << "\"}";
+        return os.str();
+    }
+
+    // Start every position from an empty table and move history
+    clearTT(*info.tt);
+    fill(&info.history[0][0][0], &info.history[0][0][0] + 2*64*64, 0);
+    ply move = findBestMove(bBoard, whiteMove, info);
+
+    os << ",\"bestmove\":" << (move != 0 ? "\"" + plyToString(move) + "\"" : string("null"));
+
+    if (move != 0 && mateMoves(info.score) != 0)
+        os << ",\"mate\":" << mateMoves(info.score);
+    else
+        os << ",\"score\":" << info.score;
+
+    os << ",\"depth\":" << info.completedDepth << ",\"nodes\":" << info.nodes << "}";
+    return os.str();
+}
+
+// Function run by each analysis thread, analysing lines until the input runs out
+void analysisThread (epdBatch &batch)
+{
+    unique_ptr <transpositionTable> table(new transpositionTable);
+    setHashSize(batch.hashMB, *table);
+
+    unique_ptr <searchInfo> info(new searchInfo);
+    info->limits = batch.limits;
+    info->tt = table.get();
+    string line;
+    int lineNum;
+
+    while (true)
+    {
+        // Take the next line that isn't blank or a comment
+        {
+            lock_guard <mutex> guard(batch.inLock);
+            do
+            {
+                if (!getline(*batch.in, line))
+                    return;
+                lineNum = ++batch.lineNum;
+
+                if (!line.empty() && line.back() == '\r')
+                    line.pop_back();
+            }
+            while (line.find_first_not_of(" \t") == string::npos || line[line.find_first_not_of(" \t")] == '#');
+        }
+
+        string result = analyzeLine(line, lineNum, *info);
+
+        lock_guard <mutex> guard(batch.outLock);
+        *batch.out << result << '\n';
+        batch.out->flush();
+        batch.numAnalysed++;
+    }
+}
+
+// Function to analyse every position in an EPD stream on a number of threads
+int analyzeEpd (istream &in, ostream &out, const searchLimits &limits, int numThreads, int hashMB)
+{
+    epdBatch batch;
+    batch.in = &in;
+    batch.out = &out;
+    batch.limits = limits;
+    batch.hashMB = hashMB;
+
+    // Every position gets a search of its own on one thread, so the threads are used for positions instead
+    batch.limits.threads = 1;
+    batch.limits.splitPoints = false;
+
+    vector <thread> threads;
+    for (int i = 0; i < max(numThreads, 1); i++)
+        threads.push_back(thread(analysisThread, ref(batch)));
+    for (unsigned int i = 0; i < threads.size(); i++)
+        threads[i].join();
+
+    return batch.numAnalysed;
+}
@@ -0,0 +1,19 @@
+/// epd_analysis.h
+///
+/// Willie Lei
+/// Header file for epd_analysis.cpp
+
+#ifndef EPD_ANALYSIS_H_INCLUDED
+#define EPD_ANALYSIS_H_INCLUDED
+
+#include <iostream>
+#include "search.h"
+
+// Function to analyse every position in an EPD (or FEN) stream with the given limits, spreading them over a number
+// of threads that each run their own single-threaded search with a table of hashMB megabytes
+// One JSON line is written for each position as soon as it is finished, so they come out in the order they finish,
+// with the line number they were read from. A position that is already checkmate or stalemate gets a result
+// instead of a best move. Returns the number of positions analysed.
+int analyzeEpd (istream &in, ostream &out, const searchLimits &limits, int numThreads, int hashMB);
+
+#endif // EPD_ANALYSIS_H_INCLUDED
@@ -0,0 +1,277 @@
+/// fen.cpp
+///
+/// Willie Lei
+/// Reading and writing positions in Forsyth-Edwards Notation (FEN) and Extended Position Description (EPD).
+///
+/// Positions are read straight into the bitboard one character at a time, with the castling rights and
+/// en passant square taken from the FEN instead of being guessed from where the pieces are.
+
+#include <cstdio>
+#include "fen.h"
+#include "zobrist.h"
+#include "piece_square_tables.h"
+
+using namespace std;
+
+// The letter of each type of piece (in the same order as pieceBoards)
+const char pieceChars[] = "PNBRQKpnbrqk";
+
+// Function to build a table of the index into pieceBoards of each letter (-1 if it isn't a piece)
+constexpr array <int, 128> makePieceIndices ()
+{
+    array <int, 128> table {};
+
+    for (int i = 0; i < 128; i++)
+        table[i] = -1;
+    for (int piece = 0; piece < 12; piece++)
+        table["PNBRQKpnbrqk"[piece]] = piece;
+
+    return table;
+}
+
+constexpr array <int, 128> pieceIndices = makePieceIndices();
+
+// The first and last rows, where there can't be any pawns
+constexpr U64 backRows = 0xFF000000000000FFULL;
+
+// Function to skip the spaces between fields
+inline const char *skipSpaces (const char *s)
+{
+    while (*s == ' ' || *s == '\t')
+        s++;
+    return s;
+}
+
+// Function to read a number field if there is one (leaving the number alone if there isn't)
+inline const char *parseNumber (const char *s, int &n)
+{
+    if (*s < '0' || *s > '9')
+        return s;
+
+    n = 0;
+    while (*s >= '0' && *s <= '9')
+        n = n*10 + (*s++ - '0');
+
+    return skipSpaces(s);
+}
+
+// Function to set up a bitboard from a FEN, or from the first four fields of an EPD line
+const char *parseFen (bitboard &bBoard, bool &whiteMove, const char *fen, int *halfMoves, int *fullMoves)
+{
+    bitboard b;
+    const char *s = skipSpaces(fen);
+    int square = 0, col = 0;
+
+    for (int piece = 0; piece < 12; piece++)
+        b.*pieceBoards[piece] = 0;
+
+    // Pieces, row by row from a8 to h1 (there can't be a row after the eighth, or a square past h1)
+    for (; *s && *s != ' ' && *s != '\t'; s++)
+    {
+        if (*s == '/')
+        {
+            if (col != 8 || square >= 64)
+                return NULL;
+            col = 0;
+        }
+        else if (*s >= '1' && *s <= '8')
+        {
+            col += *s - '0';
+            square += *s - '0';
+            if (col > 8)
+                return NULL;
+        }
+        else
+        {
+            int piece = (*s & 0x80) ? -1 : pieceIndices[*s];
+            if (piece < 0 || col >= 8 || square >= 64)
+                return NULL;
+
+            b.*pieceBoards[piece] |= sqrVal[square];
+            col++;
+            square++;
+        }
+    }
+
+    if (square != 64 || col != 8 || popCount(b.wKings) != 1 || popCount(b.bKings) != 1
+        || ((b.wPawns | b.bPawns) & backRows))
+        return NULL;
+
+    // Side to move
+    s = skipSpaces(s);
+    if (*s != 'w' && *s != 'b')
+        return NULL;
+    whiteMove = (*s++ == 'w');
+
+    // Castling rights, only kept if the king and the rook are still on their starting squares
+    s = skipSpaces(s);
+    b.wQueenSide = b.wKingSide = b.bQueenSide = b.bKingSide = false;
+    if (*s == '-')
+        s++;
+    else
+    {
+        for (; *s && *s != ' ' && *s != '\t'; s++)
+        {
+            switch (*s)
+            {
+                case 'K':
+                    b.wKingSide = (b.wKings & sqrVal[60]) && (b.wRooks & sqrVal[63]);
+                    break;
+                case 'Q':
+                    b.wQueenSide = (b.wKings & sqrVal[60]) && (b.wRooks & sqrVal[56]);
+                    break;
+                case 'k':
+                    b.bKingSide = (b.bKings & sqrVal[4]) && (b.bRooks & sqrVal[7]);
+                    break;
+                case 'q':
+                    b.bQueenSide = (b.bKings & sqrVal[4]) && (b.bRooks & sqrVal[0]);
+                    break;
+                default:
+                    return NULL;
+            }
+        }
+    }
+
+    // En passant square, stored as the pawn move of 2 squares that allowed it
+    // (ignored if there is no pawn that could have just made that move)
+    s = skipSpaces(s);
+    b.prevCurr = b.prevDest = 0;
+    if (*s == '-')
+        s++;
+    else
+    {
+        if (s[0] < 'a' || s[0] > 'h' || (s[1] != '3' && s[1] != '6'))
+            return NULL;
+
+        int epSquare = ('8' - s[1])*8 + (s[0] - 'a');
+        s += 2;
+
+        if (whiteMove && s[-1] == '6' && (b.bPawns & sqrVal[epSquare+8]))
+        {
+            b.prevCurr = epSquare - 8;
+            b.prevDest = epSquare + 8;
+        }
+        else if (!whiteMove && s[-1] == '3' && (b.wPawns & sqrVal[epSquare-8]))
+        {
+            b.prevCurr = epSquare + 8;
+            b.prevDest = epSquare - 8;
+        }
+    }
+
+    if (*s && *s != ' ' && *s != '\t')
+        return NULL;
+    s = skipSpaces(s);
+
+    // Halfmove clock and fullmove number (FEN only)
+    int halfMoveNum = 0, fullMoveNum = 1;
+    s = parseNumber(s, halfMoveNum);
+    s = parseNumber(s, fullMoveNum);
+    if (halfMoves)
+        *halfMoves = halfMoveNum;
+    if (fullMoves)
+        *fullMoves = fullMoveNum;
+
+    // Material, unions, hash key and piece-square values
+    b.wMaterialVal = b.bMaterialVal = 0;
+    for (int piece = 0; piece < 6; piece++)
+    {
+        b.wMaterialVal += popCount(b.*pieceBoards[piece]) * pieceVals[piece];
+        b.bMaterialVal += popCount(b.*pieceBoards[piece+6]) * pieceVals[piece];
+    }
+
+    b.prevWasQuiet = true;
+    b.updateUnions();
+
+    // The side that just moved can't have left its king in check (the search would capture the king)
+    int enemyKing = whiteMove ? getBKingLoc(b) : getWKingLoc(b);
+    if (attackersTo(b, enemyKing, b.pieces) & (whiteMove ? b.wPieces : b.bPieces))
+        return NULL;
+
+    b.key = calcZobristKey(b, whiteMove);
+    calcPieceSquareVals(b);
+
+    bBoard = b;
+    return s;
+}
+
+// Function to write the first four fields of a FEN (the same as an EPD line without operations), returning the end
+char *writeFenFields (const bitboard &bBoard, bool whiteMove, char *p)
+{
+    // Put the letter of every piece on its square
+    char squares[64] = {};
+    for (int piece = 0; piece < 12; piece++)
+    {
+        U64 pieces = bBoard.*pieceBoards[piece];
+        while (pieces)
+            squares[popSquare(pieces)] = pieceChars[piece];
+    }
+
+    // Pieces, row by row from a8 to h1, with the number of empty squares between them
+    for (int row = 0; row < 8; row++)
+    {
+        int empty = 0;
+        for (int col = 0; col < 8; col++)
+        {
+            char c = squares[row*8 + col];
+            if (!c)
+                empty++;
+            else
+            {
+                if (empty)
+                    *p++ = '0' + empty;
+                *p++ = c;
+                empty = 0;
+            }
+        }
+
+        if (empty)
+            *p++ = '0' + empty;
+        if (row < 7)
+            *p++ = '/';
+    }
+
+    // Side to move
+    *p++ = ' ';
+    *p++ = whiteMove ? 'w' : 'b';
+
+    // Castling rights
+    *p++ = ' ';
+    if (!(bBoard.wKingSide || bBoard.wQueenSide || bBoard.bKingSide || bBoard.bQueenSide))
+        *p++ = '-';
+    if (bBoard.wKingSide)
+        *p++ = 'K';
+    if (bBoard.wQueenSide)
+        *p++ = 'Q';
+    if (bBoard.bKingSide)
+        *p++ = 'k';
+    if (bBoard.bQueenSide)
+        *p++ = 'q';
+
+    // En passant square (behind the pawn that just moved 2 squares)
+    *p++ = ' ';
+    if (getEnPassantCol(bBoard) >= 0)
+    {
+        *p++ = 'a' + getEnPassantCol(bBoard);
+        *p++ = (bBoard.prevDest/8 == 3) ? '6' : '3';
+    }
+    else
+        *p++ = '-';
+
+    return p;
+}
+
+// Function to write a position as a FEN
+string boardToFen (const bitboard &bBoard, bool whiteMove, int halfMoves, int fullMoves)
+{
+    char buffer[128];
+    char *p = writeFenFields(bBoard, whiteMove, buffer);
+    p += snprintf(p, buffer + sizeof(buffer) - p, " %d %d", halfMoves, fullMoves);
+    return string(buffer, p);
+}
+
+// Function to write a position as the first four fields of an EPD line
+string boardToEpd (const bitboard &bBoard, bool whiteMove)
+{
+    char buffer[128];
+    return string(buffer, writeFenFields(bBoard, whiteMove, buffer));
+}
@@ -0,0 +1,25 @@
+/// fen.h
+///
+/// Willie Lei
+/// Header file for fen.cpp
+
+#ifndef FEN_H_INCLUDED
+#define FEN_H_INCLUDED
+
+#include <string>
+#include "legal_moves.h"
+
+// The starting position
+#define STARTFEN "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1"
+
+// Function to set up a bitboard from a FEN, or from the first four fields of an EPD line
+// The halfmove clock and fullmove number are read if they are there and stored if asked for
+// Returns a pointer to the next field (e.g. the operations of an EPD line), or NULL if the position isn't valid,
+// in which case the bitboard is left as it was
+const char *parseFen (bitboard &bBoard, bool &whiteMove, const char *fen, int *halfMoves = NULL, int *fullMoves = NULL);
+
+// Functions to write a position as a FEN, or as the first four fields of an EPD line
+string boardToFen (const bitboard &bBoard, bool whiteMove, int halfMoves = 0, int fullMoves = 1);
+string boardToEpd (const bitboard &bBoard, bool whiteMove);
+
+#endif // FEN_H_INCLUDED
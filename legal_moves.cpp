@@ -6,14 +6,25 @@
 #include <iostream>
 #include <vector>
 #include <string>
-#include <fstream>
-#include <cmath>
 #include <cstdlib>
 #include "legal_moves.h"
+#include "magics.h"
+#include "zobrist.h"
+#include "piece_square_tables.h"
 
 #define ISWHITEMOVE (moveNum%2 == 1)
 #define ISBLACKMOVE (moveNum%2 == 0)
 
+// Masks for the columns on the edges and for the rows pawns can move 2 squares from after moving 1
+#define AFILE 0x8080808080808080ULL
+#define HFILE 0x0101010101010101ULL
+#define WHITEPUSH2 0x0000000000FF0000ULL
+#define BLACKPUSH2 0x0000FF0000000000ULL
+
+// Masks for the rows white and black pawns promote on
+#define WHITEPROMOTE 0xFF00000000000000ULL
+#define BLACKPROMOTE 0x00000000000000FFULL
+
 #define INITLINE8 "rnbqkbnr"
 #define INITLINE7 "pppppppp"
 #define INITLINE6 "        "
@@ -34,19 +45,13 @@ void bitboard::updateUnions ()
     blank = ~pieces;
 }
 
-// Arrays of the value of each square and a bitboards of where all the pieces can move to from each square
-U64 sqrVal[64];
-U64 wPawn1Dir[64], wPawn2Dir[64], wPawnCapDir[64], bPawn1Dir[64], bPawn2Dir[64], bPawnCapDir[64], knightDir[64], kingDir[64];
-U64 rightDir[64], leftDir[64], upDir[64], downDir[64], deg45Dir[64], deg135Dir[64], deg225Dir[64], deg315Dir[64];
-
 // Function to allow the user to play chess as a two player game (no AI)
 void twoPlayerGame ()
 {
     // Initialize the arrays, the bitboard, the vector, variables etc.
-    getDirections();
+    initMagics();
     bitboard bBoard;
     svec sBoard;
-    plyvec legalMoves;
     string input;
     int moveNum = 1, curr, dest;
 
@@ -87,9 +92,6 @@ void twoPlayerGame ()
             continue;
         }
 
-        // Get all possible legal moves
-        legalMoves = getLegalMoves(bBoard, ISWHITEMOVE);
-
         // Check to see if the move is a regular legal move for white
         if (isLegalMove(bBoard, curr, dest))
         {
@@ -107,9 +109,9 @@ void twoPlayerGame ()
 
             cout << "Illegal move. " << endl;
 
-            if (ISWHITEMOVE && isInCheck(bb2, 63-log2(bb2.wKings)))
+            if (ISWHITEMOVE && isInCheck(bb2, getWKingLoc(bb2)))
                 cout << "White king is in check" << endl;
-            if (ISBLACKMOVE && isInCheck(bb2, 63-log2(bb2.bKings)))
+            if (ISBLACKMOVE && isInCheck(bb2, getBKingLoc(bb2)))
                 cout << "Black king is in check" << endl;
         }
         // Check for checkmate or stalemate
@@ -133,139 +135,312 @@ void twoPlayerGame ()
 }
 
 // Function to return all the legal moves for a particular colour
-plyvec getLegalMoves (bitboard bBoard, bool whiteMove)
+void getLegalMoves (const bitboard &bBoard, bool whiteMove, plyList &legalMoves)
+{
+    generateMoves(bBoard, whiteMove, legalMoves, false, getCheckers(bBoard, whiteMove));
+}
+
+// Function to return only the legal captures and promotions for a particular colour (for the quiescence search)
+void getTacticalMoves (const bitboard &bBoard, bool whiteMove, plyList &tacticalMoves)
+{
+    generateMoves(bBoard, whiteMove, tacticalMoves, true, getCheckers(bBoard, whiteMove));
+}
+
+// Function to generate the legal moves for a particular colour, or only the captures and promotions if tacticalOnly is set
+// Pinned pieces and checks are worked out once, so only king moves and en passant need to be tested separately
+// checkers must be the pieces giving check (from getCheckers), which the search already has
+void generateMoves (const bitboard &bBoard, bool whiteMove, plyList &legalMoves, bool tacticalOnly, U64 checkers)
 {
-    plyvec legalMoves;
+    legalMoves.size = 0;
+
+    // Sort the pieces into the ones of the side to move and the ones of the opponent
+    U64 ownPieces = whiteMove ? bBoard.wPieces : bBoard.bPieces;
+    U64 enemyPieces = whiteMove ? bBoard.bPieces : bBoard.wPieces;
+    U64 ownPawns = whiteMove ? bBoard.wPawns : bBoard.bPawns;
+    U64 ownKnights = whiteMove ? bBoard.wKnights : bBoard.bKnights;
+    U64 ownSliders = whiteMove ? (bBoard.wBishops | bBoard.wRooks | bBoard.wQueens) : (bBoard.bBishops | bBoard.bRooks | bBoard.bQueens);
+    int king = whiteMove ? getWKingLoc(bBoard) : getBKingLoc(bBoard);
+
+    // The squares moves can go to when only captures and promotions are wanted (pawns also promote on the last row)
+    U64 captureMask = tacticalOnly ? enemyPieces : ~0ULL;
+    U64 promotionMask = tacticalOnly ? (whiteMove ? WHITEPROMOTE : BLACKPROMOTE) : ~0ULL;
 
-    // Check if the move is for white or black
+    // Find the pieces that are pinned to the king
+    U64 pinned = getPinned(bBoard, king, whiteMove);
+
+    // Every square the opponent attacks, worked out without the king (which can't block an attack on its new square)
+    U64 enemyAttacks = attackedBy(bBoard, !whiteMove, bBoard.pieces - sqrVal[king]);
+
+    // King moves - the king must not move to an attacked square
+    addMoves(legalMoves, king, kingDir[king] & ~ownPieces & ~enemyAttacks & captureMask);
+
+    // Only the king can move out of a double check
+    if (checkers & (checkers - 1))
+        return;
+
+    // The squares the other pieces have to move to (capturing the piece giving check or blocking it if in check)
+    U64 targets = ~ownPieces;
+    if (checkers)
+    {
+        targets &= checkers | sqrsBetween[king][firstSquare(checkers)];
+    }
+    // Castling (which is never allowed out of check)
+    else if (!tacticalOnly)
+    {
+        addMoves(legalMoves, king, getCastlingMoves(bBoard, king, enemyAttacks), CASTLING);
+    }
+
+    // Pawn moves for all the pawns that aren't pinned at once
+    U64 pawns = ownPawns & ~pinned;
     if (whiteMove)
     {
-        // Loop through all the possible source and destination squares
-        for (int curr = 0; curr < 64; curr++)
-        {
-            U64 moves = 0;
+        U64 push1 = (pawns << 8) & bBoard.blank;
+        U64 push2 = ((push1 & WHITEPUSH2) << 8) & bBoard.blank;
+        addPawnMoves(legalMoves, push1 & targets & promotionMask, 8);
+        addPawnMoves(legalMoves, push2 & targets & captureMask, 16);
+        addPawnMoves(legalMoves, (pawns << 9) & ~HFILE & enemyPieces & targets, 9);
+        addPawnMoves(legalMoves, (pawns << 7) & ~AFILE & enemyPieces & targets, 7);
+    }
+    else
+    {
+        U64 push1 = (pawns >> 8) & bBoard.blank;
+        U64 push2 = ((push1 & BLACKPUSH2) >> 8) & bBoard.blank;
+        addPawnMoves(legalMoves, push1 & targets & promotionMask, -8);
+        addPawnMoves(legalMoves, push2 & targets & captureMask, -16);
+        addPawnMoves(legalMoves, (pawns >> 7) & ~HFILE & enemyPieces & targets, -7);
+        addPawnMoves(legalMoves, (pawns >> 9) & ~AFILE & enemyPieces & targets, -9);
+    }
 
-            // Check to see what piece occupies that square
-            if ((bBoard.blank | bBoard.bPieces) & sqrVal[curr])
-                continue;
-            else if (bBoard.wPawns & sqrVal[curr])
-                moves = getPawnMoves(bBoard, curr) | getEnPassant(bBoard, curr);
-            else if (bBoard.wKnights & sqrVal[curr])
-                moves = getKnightMoves(bBoard, curr);
-            else if (bBoard.wBishops & sqrVal[curr])
-                moves = getBishopMoves(bBoard, curr);
-            else if (bBoard.wRooks & sqrVal[curr])
-                moves = getRookMoves(bBoard, curr);
-            else if (bBoard.wQueens & sqrVal[curr])
-                moves = getQueenMoves(bBoard, curr);
-            else if (bBoard.wKings & sqrVal[curr])
-                moves = getKingMoves(bBoard, curr) | getCastlingMoves(bBoard, curr);
-
-            if (moves == 0)
-                continue;
+    // Pinned pawns and the pieces (pinned knights can never move)
+    U64 movers = (ownPawns & pinned) | (ownKnights & ~pinned) | ownSliders;
+    while (movers)
+    {
+        int curr = popSquare(movers);
+        U64 moves = 0;
+
+        // Check to see what piece occupies that square
+        if (ownPawns & sqrVal[curr])
+            moves = getPawnMoves(bBoard, curr);
+        else if (ownKnights & sqrVal[curr])
+            moves = knightDir[curr];
+        else if ((bBoard.wBishops | bBoard.bBishops) & sqrVal[curr])
+            moves = bishopAttacks(bBoard.pieces, curr);
+        else if ((bBoard.wRooks | bBoard.bRooks) & sqrVal[curr])
+            moves = rookAttacks(bBoard.pieces, curr);
+        else
+            moves = bishopAttacks(bBoard.pieces, curr) | rookAttacks(bBoard.pieces, curr);
 
-            // Go through all the destination squares to see if that move is legal
-            for (int dest = 0; dest < 64; dest++)
-            {
-                // Check if the piece can indeed move to the dest. square
-                if (moves & sqrVal[dest])
-                {
-                    bitboard bBoard2 = updateBitboard(bBoard, curr, dest, true);
-
-                    // Check for checks
-                    if (!isInCheck(bBoard2, getWKingLoc(bBoard2)))
-                    {
-                        ply p;
-                        p.curr = curr;
-                        p.dest = dest;
-                        legalMoves.push_back(p);
-                    }
-                }
-            }
-        }
+        // A pinned piece can only move along the line between the king and the piece pinning it
+        moves &= targets;
+        if (pinned & sqrVal[curr])
+            moves &= sqrsInLine[king][curr];
+
+        // Pawns moving to the last row get a move for each promotion piece
+        if (ownPawns & sqrVal[curr])
+            addPawnMoves(legalMoves, moves & (captureMask | promotionMask), 0, curr);
+        else
+            addMoves(legalMoves, curr, moves & captureMask);
     }
-    else
+
+    // En passant - look for checks with both pawns moved, since it removes two pieces from the same row
+    if (getEnPassantCol(bBoard) >= 0)
     {
-        // Loop through all the possible source and destination squares
-        for (int curr = 0; curr < 64; curr++)
-        {
-            U64 moves = 0;
+        int dest = whiteMove ? bBoard.prevDest-8 : bBoard.prevDest+8;
 
-            // Check to see what piece occupies that square
-            if ((bBoard.blank | bBoard.wPieces) & sqrVal[curr])
-                continue;
-            else if (bBoard.bPawns & sqrVal[curr])
-                moves = getPawnMoves(bBoard, curr) | getEnPassant(bBoard, curr);
-            else if (bBoard.bKnights & sqrVal[curr])
-                moves = getKnightMoves(bBoard, curr);
-            else if (bBoard.bBishops & sqrVal[curr])
-                moves = getBishopMoves(bBoard, curr);
-            else if (bBoard.bRooks & sqrVal[curr])
-                moves = getRookMoves(bBoard, curr);
-            else if (bBoard.bQueens & sqrVal[curr])
-                moves = getQueenMoves(bBoard, curr);
-            else if (bBoard.bKings & sqrVal[curr])
-                moves = getKingMoves(bBoard, curr) | getCastlingMoves(bBoard, curr);
-
-            if (moves == 0)
+        // Look at the squares on either side of the pawn that just moved
+        for (int curr = bBoard.prevDest - 1; curr <= bBoard.prevDest + 1; curr += 2)
+        {
+            if (curr/8 != bBoard.prevDest/8 || !(getEnPassant(bBoard, curr) & sqrVal[dest]))
                 continue;
 
-            // Go through all the destination squares to see if that move is legal
-            for (int dest = 0; dest < 64; dest++)
-            {
-                // Check if the piece can indeed move to the dest. square
-                if (moves & sqrVal[dest])
-                {
-                    bitboard bBoard2 = updateBitboard(bBoard, curr, dest, true);
-
-                    // Check for checks
-                    if (!isInCheck(bBoard2, getBKingLoc(bBoard2)))
-                    {
-                        ply p;
-                        p.curr = curr;
-                        p.dest = dest;
-                        legalMoves.push_back(p);
-                    }
-                }
-            }
+            U64 occupancy = bBoard.pieces - sqrVal[curr] - sqrVal[bBoard.prevDest] + sqrVal[dest];
+            if (!(attackersTo(bBoard, king, occupancy) & enemyPieces & ~sqrVal[bBoard.prevDest]))
+                addMoves(legalMoves, curr, sqrVal[dest], ENPASSANT);
         }
     }
+}
 
-    return legalMoves;
+// Function to add a move from one square to each of a set of destination squares
+void addMoves (plyList &moves, int curr, U64 dests, int type)
+{
+    while (dests)
+        moves.add(makePly(curr, popSquare(dests), type));
 }
 
-// Function to check the legality of a move
-bool areLegalMoves (bitboard bBoard, bool whiteMove)
+// Function to add pawn moves to each of a set of destination squares
+// The pawn starts a fixed number of squares away from the destination, or on the square curr if offset is 0
+void addPawnMoves (plyList &moves, U64 dests, int offset, int curr)
 {
-    // Check if the move is for white or black
-    if (whiteMove)
+    while (dests)
     {
-        // Loop through all the possible source and destination squares
-        for (int curr = 0; curr < 64; curr++)
+        int dest = popSquare(dests);
+        int from = (offset != 0) ? dest + offset : curr;
+
+        // Add one move for each piece a pawn reaching the last row can promote to (best piece first)
+        if (dest/8 == 0 || dest/8 == 7)
         {
-            for (int dest = 0; dest < 64; dest++)
-            {
-                // If the move is legal, return true
-                if ((bBoard.wPieces & sqrVal[curr]) && isLegalMove(bBoard, curr, dest))
-                {
-                    return true;
-                }
-            }
+            moves.add(makePly(from, dest, PROMOTION, QUEEN));
+            moves.add(makePly(from, dest, PROMOTION, KNIGHT));
+            moves.add(makePly(from, dest, PROMOTION, ROOK));
+            moves.add(makePly(from, dest, PROMOTION, BISHOP));
+        }
+        else
+        {
+            moves.add(makePly(from, dest));
         }
     }
+}
+
+// Function to return the pieces of the side to move that are pinned to their king
+U64 getPinned (const bitboard &bBoard, int king, bool whiteMove)
+{
+    U64 ownPieces = whiteMove ? bBoard.wPieces : bBoard.bPieces;
+    U64 enemyPieces = whiteMove ? bBoard.bPieces : bBoard.wPieces;
+    U64 pinned = 0;
+
+    // Find the enemy sliders that would attack the king if the king's own pieces weren't there
+    U64 snipers = (bishopAttacks(enemyPieces, king) & (bBoard.wBishops | bBoard.bBishops | bBoard.wQueens | bBoard.bQueens))
+                | (rookAttacks(enemyPieces, king) & (bBoard.wRooks | bBoard.bRooks | bBoard.wQueens | bBoard.bQueens));
+    snipers &= enemyPieces;
+
+    // A piece is pinned if it is the only piece between the king and a sniper
+    while (snipers)
+    {
+        U64 blockers = sqrsBetween[king][popSquare(snipers)] & bBoard.pieces;
+        if (blockers && !(blockers & (blockers - 1)) && (blockers & ownPieces))
+            pinned |= blockers;
+    }
+
+    return pinned;
+}
+
+// Function to return the pieces of both colours attacking a square, given which squares are occupied
+U64 attackersTo (const bitboard &bBoard, int square, U64 occupancy)
+{
+    return (bPawnCapDir[square] & bBoard.wPawns)
+         | (wPawnCapDir[square] & bBoard.bPawns)
+         | (knightDir[square] & (bBoard.wKnights | bBoard.bKnights))
+         | (kingDir[square] & (bBoard.wKings | bBoard.bKings))
+         | (bishopAttacks(occupancy, square) & (bBoard.wBishops | bBoard.bBishops | bBoard.wQueens | bBoard.bQueens))
+         | (rookAttacks(occupancy, square) & (bBoard.wRooks | bBoard.bRooks | bBoard.wQueens | bBoard.bQueens));
+}
+
+// Function to return every square attacked by the pieces of one colour, given which squares are occupied
+U64 attackedBy (const bitboard &bBoard, bool byWhite, U64 occupancy)
+{
+    U64 attacks;
+    U64 knights = byWhite ? bBoard.wKnights : bBoard.bKnights;
+    U64 diagonals = byWhite ? (bBoard.wBishops | bBoard.wQueens) : (bBoard.bBishops | bBoard.bQueens);
+    U64 straights = byWhite ? (bBoard.wRooks | bBoard.wQueens) : (bBoard.bRooks | bBoard.bQueens);
+    U64 kings = byWhite ? bBoard.wKings : bBoard.bKings;
+
+    // The pawns all attack at once
+    if (byWhite)
+        attacks = ((bBoard.wPawns << 9) & ~HFILE) | ((bBoard.wPawns << 7) & ~AFILE);
     else
+        attacks = ((bBoard.bPawns >> 7) & ~HFILE) | ((bBoard.bPawns >> 9) & ~AFILE);
+
+    U64 pieces = knights | diagonals | straights | kings;
+    while (pieces)
     {
-        // Loop through all the possible source and destination squares
-        for (int curr = 0; curr < 64; curr++)
+        int square = popSquare(pieces);
+
+        if (knights & sqrVal[square])
+            attacks |= knightDir[square];
+        if (kings & sqrVal[square])
+            attacks |= kingDir[square];
+        if (diagonals & sqrVal[square])
+            attacks |= bishopAttacks(occupancy, square);
+        if (straights & sqrVal[square])
+            attacks |= rookAttacks(occupancy, square);
+    }
+
+    return attacks;
+}
+
+// Function to return whether a side has any legal move, stopping at the first one it finds
+bool areLegalMoves (const bitboard &bBoard, bool whiteMove)
+{
+    // Sort the pieces the same way as generateMoves, but stop as soon as any legal move is found
+    U64 ownPieces = whiteMove ? bBoard.wPieces : bBoard.bPieces;
+    U64 enemyPieces = whiteMove ? bBoard.bPieces : bBoard.wPieces;
+    U64 ownPawns = whiteMove ? bBoard.wPawns : bBoard.bPawns;
+    U64 ownKnights = whiteMove ? bBoard.wKnights : bBoard.bKnights;
+    U64 ownSliders = whiteMove ? (bBoard.wBishops | bBoard.wRooks | bBoard.wQueens) : (bBoard.bBishops | bBoard.bRooks | bBoard.bQueens);
+    int king = whiteMove ? getWKingLoc(bBoard) : getBKingLoc(bBoard);
+
+    // King moves (castling never needs to be tested, since the king can always step to the square it passes through)
+    if (kingDir[king] & ~ownPieces & ~attackedBy(bBoard, !whiteMove, bBoard.pieces - sqrVal[king]))
+        return true;
+
+    U64 checkers = attackersTo(bBoard, king, bBoard.pieces) & enemyPieces;
+    if (checkers & (checkers - 1))
+        return false;
+
+    U64 targets = ~ownPieces;
+    if (checkers)
+    {
+        targets &= checkers | sqrsBetween[king][firstSquare(checkers)];
+    }
+
+    // Pawns that aren't pinned, all at once
+    U64 pinned = getPinned(bBoard, king, whiteMove);
+    U64 pawns = ownPawns & ~pinned;
+    U64 pawnMoves;
+    if (whiteMove)
+    {
+        U64 push1 = (pawns << 8) & bBoard.blank;
+        pawnMoves = push1 | (((push1 & WHITEPUSH2) << 8) & bBoard.blank)
+                  | ((pawns << 9) & ~HFILE & enemyPieces) | ((pawns << 7) & ~AFILE & enemyPieces);
+    }
+    else
+    {
+        U64 push1 = (pawns >> 8) & bBoard.blank;
+        pawnMoves = push1 | (((push1 & BLACKPUSH2) >> 8) & bBoard.blank)
+                  | ((pawns >> 7) & ~HFILE & enemyPieces) | ((pawns >> 9) & ~AFILE & enemyPieces);
+    }
+    if (pawnMoves & targets)
+        return true;
+
+    // Pinned pawns and the pieces
+    U64 movers = (ownPawns & pinned) | (ownKnights & ~pinned) | ownSliders;
+    while (movers)
+    {
+        int curr = popSquare(movers);
+        U64 moves = 0;
+
+        if (ownPawns & sqrVal[curr])
+            moves = getPawnMoves(bBoard, curr);
+        else if (ownKnights & sqrVal[curr])
+            moves = knightDir[curr];
+        else if ((bBoard.wBishops | bBoard.bBishops) & sqrVal[curr])
+            moves = bishopAttacks(bBoard.pieces, curr);
+        else if ((bBoard.wRooks | bBoard.bRooks) & sqrVal[curr])
+            moves = rookAttacks(bBoard.pieces, curr);
+        else
+            moves = bishopAttacks(bBoard.pieces, curr) | rookAttacks(bBoard.pieces, curr);
+
+        moves &= targets;
+        if (pinned & sqrVal[curr])
+            moves &= sqrsInLine[king][curr];
+
+        if (moves)
+            return true;
+    }
+
+    // En passant
+    if (getEnPassantCol(bBoard) >= 0)
+    {
+        int dest = whiteMove ? bBoard.prevDest-8 : bBoard.prevDest+8;
+
+        for (int curr = bBoard.prevDest - 1; curr <= bBoard.prevDest + 1; curr += 2)
         {
-            for (int dest = 0; dest < 64; dest++)
-            {
-                // If the move is legal, return true
-                if ((bBoard.bPieces & sqrVal[curr]) && isLegalMove(bBoard, curr, dest))
-                {
-                    return true;
-                }
-            }
+            if (curr/8 != bBoard.prevDest/8 || !(getEnPassant(bBoard, curr) & sqrVal[dest]))
+                continue;
+
+            U64 occupancy = bBoard.pieces - sqrVal[curr] - sqrVal[bBoard.prevDest] + sqrVal[dest];
+            if (!(attackersTo(bBoard, king, occupancy) & enemyPieces & ~sqrVal[bBoard.prevDest]))
+                return true;
         }
     }
 
@@ -273,7 +448,7 @@ bool areLegalMoves (bitboard bBoard, bool whiteMove)
 }
 
 // Function to check if something is a legal move
-bool isLegalMove (bitboard bBoard, int curr, int dest)
+bool isLegalMove (const bitboard &bBoard, int curr, int dest)
 {
     // Check for an invalid move
     // Check if the square is blank
@@ -295,7 +470,7 @@ bool isLegalMove (bitboard bBoard, int curr, int dest)
     if (((bBoard.wQueens | bBoard.bQueens) & sqrVal[curr]) && !(getQueenMoves(bBoard, curr) & sqrVal[dest]))
         return false;
     // Check if the move is an invalid king move
-    if (((bBoard.wKings | bBoard.bKings) & sqrVal[curr]) && !(getKingMoves(bBoard, curr) & sqrVal[dest]) && !(getCastlingMoves(bBoard, curr) & sqrVal[dest]))
+    if (((bBoard.wKings | bBoard.bKings) & sqrVal[curr]) && !(getKingMoves(bBoard, curr) & sqrVal[dest]) && !(getCastlingMoves(bBoard, curr, attackedBy(bBoard, !(bBoard.wPieces & sqrVal[curr]), bBoard.pieces)) & sqrVal[dest]))
         return false;
 
     // Check to see if the white king is in check if white is moving
@@ -312,393 +487,266 @@ bool isLegalMove (bitboard bBoard, int curr, int dest)
     }
 }
 
-// Function to determine if a square is under attack by a piece of the opposite colour
-bool isInCheck (bitboard bBoard, int square)
+// Function to return the pieces giving check to the king of a particular colour
+U64 getCheckers (const bitboard &bBoard, bool whiteMove)
 {
-    // For a white king
-    if (bBoard.wPieces & sqrVal[square])
-    {
-        // Pretend the king is a piece and see if it can capture an identical piece of the opposite colour
-        if (getPawnMoves(bBoard, square) & bBoard.bPawns)
-            return true;
-        if (getKnightMoves(bBoard, square) & bBoard.bKnights)
-            return true;
-        if (getBishopMoves(bBoard, square) & bBoard.bBishops)
-            return true;
-        if (getRookMoves(bBoard, square) & bBoard.bRooks)
-            return true;
-        if ((getQueenMoves(bBoard, square)) & bBoard.bQueens)
-            return true;
-        if (getKingMoves(bBoard, square) & bBoard.bKings)
-            return true;
-    }
-    // For a black king
-    else
-    {
-        // Pretend the king is a piece and see if it can capture an identical piece of the opposite colour
-        if (getPawnMoves(bBoard, square) & bBoard.wPawns)
-            return true;
-        if (getKnightMoves(bBoard, square) & bBoard.wKnights)
-            return true;
-        if (getBishopMoves(bBoard, square) & bBoard.wBishops)
-            return true;
-        if (getRookMoves(bBoard, square) & bBoard.wRooks)
-            return true;
-        if ((getQueenMoves(bBoard, square)) & bBoard.wQueens)
-            return true;
-        if (getKingMoves(bBoard, square) & bBoard.wKings)
-            return true;
-    }
+    int king = whiteMove ? getWKingLoc(bBoard) : getBKingLoc(bBoard);
+    return attackersTo(bBoard, king, bBoard.pieces) & (whiteMove ? bBoard.bPieces : bBoard.wPieces);
+}
 
-    return false;
+// Function to determine if a square is under attack by a piece of the opposite colour
+bool isInCheck (const bitboard &bBoard, int square)
+{
+    U64 enemyPieces = (bBoard.wPieces & sqrVal[square]) ? bBoard.bPieces : bBoard.wPieces;
+    return attackersTo(bBoard, square, bBoard.pieces) & enemyPieces;
 }
 
 // Function to update a bitboard after a regular move
-bitboard updateBitboard (bitboard oldBBoard, int curr, int dest, bool moveIsComp)
+// Asks the user what to promote to if a pawn reaches the last row, unless the move is by the computer
+bitboard updateBitboard (const bitboard &oldBBoard, int curr, int dest, bool moveIsComp)
 {
     bitboard bBoard = oldBBoard;
+    undo u;
+    char promotion = 'q';
 
-    // Update the bitboard after en passant
-    if (getEnPassant(bBoard, curr) & sqrVal[dest])
-    {
-        bBoard.prevWasQuiet = false;
+    if (!moveIsComp && (((bBoard.wPawns & sqrVal[curr]) && dest/8 == 0) || ((bBoard.bPawns & sqrVal[curr]) && dest/8 == 7)))
+        promotion = getPromotionPiece()[0];
 
-        if (bBoard.wPieces & sqrVal[curr])
-            bBoard.bMaterialVal -= 100;
-        else
-            bBoard.wMaterialVal -= 100;
+    makeMove(bBoard, squaresToPly(bBoard, curr, dest, promotion), u);
+    return bBoard;
+}
 
-        return updateBBoardEnPass(bBoard, curr, dest);;
-    }
-    // Update the bitboard after castling
-    if (getCastlingMoves(bBoard, curr) & sqrVal[dest])
+// Function to work out the full ply for a move given by its squares (and the piece to promote to, as a letter)
+// A king moving two columns is castling and a pawn moving diagonally to a blank square is en passant
+ply squaresToPly (const bitboard &bBoard, int curr, int dest, char promotion)
+{
+    if (((bBoard.wPawns | bBoard.bPawns) & sqrVal[curr]) && (dest/8 == 0 || dest/8 == 7))
     {
-        bBoard.prevWasQuiet = true;
-        return updateBBoardCast(bBoard, curr, dest);
+        switch (promotion)
+        {
+            case 'n':
+                return makePly(curr, dest, PROMOTION, KNIGHT);
+            case 'b':
+                return makePly(curr, dest, PROMOTION, BISHOP);
+            case 'r':
+                return makePly(curr, dest, PROMOTION, ROOK);
+            default:
+                return makePly(curr, dest, PROMOTION, QUEEN);
+        }
     }
+    if (((bBoard.wPawns | bBoard.bPawns) & sqrVal[curr]) && curr%8 != dest%8 && (bBoard.blank & sqrVal[dest]))
+        return makePly(curr, dest, ENPASSANT);
+    if (((bBoard.wKings | bBoard.bKings) & sqrVal[curr]) && absDiff(curr%8, dest%8) == 2)
+        return makePly(curr, dest, CASTLING);
 
-    // Record that the previous move was quiet and only change that if there was a capture or a promotion
+    return makePly(curr, dest);
+}
+
+// Function to make a move on a bitboard in place, storing what is needed to take it back in an undo record
+// The move is assumed to be legal
+void makeMove (bitboard &bBoard, ply p, undo &u)
+{
+    int curr = plyCurr(p), dest = plyDest(p);
+
+    // Save the parts of the bitboard that can't be worked out from the move
+    u.curr = curr;
+    u.dest = dest;
+    u.movedPiece = getPieceOn(bBoard, curr);
+    u.capturedPiece = -1;
+    u.capturedSqr = dest;
+    u.promotedPiece = -1;
+    u.prevCurr = bBoard.prevCurr;
+    u.prevDest = bBoard.prevDest;
+    u.wQueenSide = bBoard.wQueenSide;
+    u.wKingSide = bBoard.wKingSide;
+    u.bQueenSide = bBoard.bQueenSide;
+    u.bKingSide = bBoard.bKingSide;
+    u.wMaterialVal = bBoard.wMaterialVal;
+    u.bMaterialVal = bBoard.bMaterialVal;
+    u.mgVal = bBoard.mgVal;
+    u.egVal = bBoard.egVal;
+    u.phase = bBoard.phase;
+    u.prevWasQuiet = bBoard.prevWasQuiet;
+    u.key = bBoard.key;
+
+    bool isWhite = u.movedPiece < 6;
+
+    // Take the castling rights and en passant column out of the key (they are added back at the end)
+    bBoard.key ^= getCastlingKey(bBoard);
+    if (getEnPassantCol(bBoard) >= 0)
+        bBoard.key ^= zobrist.enPassant[getEnPassantCol(bBoard)];
+
+    // Record that the move was quiet and only change that if there was a capture or a promotion
     bBoard.prevWasQuiet = true;
 
+    // For en passant, the captured pawn is behind the destination square
+    if (plyType(p) == ENPASSANT)
+        u.capturedSqr = isWhite ? dest+8 : dest-8;
+
     // Remove a piece after a capture
-    if (bBoard.pieces & sqrVal[dest])
+    if (bBoard.pieces & sqrVal[u.capturedSqr])
     {
+        u.capturedPiece = getPieceOn(bBoard, u.capturedSqr);
+        bBoard.*pieceBoards[u.capturedPiece] -= sqrVal[u.capturedSqr];
+        bBoard.key ^= zobrist.pieces[u.capturedPiece][u.capturedSqr];
+        removePieceSquareVal(bBoard, u.capturedPiece, u.capturedSqr);
         bBoard.prevWasQuiet = false;
 
-        // Check what piece is captured
-        // If a white piece is captured ...
-        if (bBoard.wPawns & sqrVal[dest])
-        {
-            bBoard.wPawns -= sqrVal[dest];
-            bBoard.wMaterialVal -= 100;
-        }
-        else if (bBoard.wKnights & sqrVal[dest])
-        {
-            bBoard.wKnights -= sqrVal[dest];
-            bBoard.wMaterialVal -= 310;
-        }
-        else if (bBoard.wBishops & sqrVal[dest])
-        {
-            bBoard.wBishops -= sqrVal[dest];
-            bBoard.wMaterialVal -= 320;
-        }
-        else if (bBoard.wRooks & sqrVal[dest])
-        {
-            bBoard.wRooks -= sqrVal[dest];
-            bBoard.wMaterialVal -= 500;
-        }
-        else if (bBoard.wQueens & sqrVal[dest])
-        {
-            bBoard.wQueens -= sqrVal[dest];
-            bBoard.wMaterialVal -= 1000;
-        }
-        // If a black piece is captured ...
-        else if (bBoard.bPawns & sqrVal[dest])
-        {
-            bBoard.bPawns -= sqrVal[dest];
-            bBoard.bMaterialVal -= 100;
-        }
-        else if (bBoard.bKnights & sqrVal[dest])
-        {
-            bBoard.bKnights -= sqrVal[dest];
-            bBoard.bMaterialVal -= 310;
-        }
-        else if (bBoard.bBishops & sqrVal[dest])
-        {
-            bBoard.bBishops -= sqrVal[dest];
-            bBoard.bMaterialVal -= 320;
-        }
-        else if (bBoard.bRooks & sqrVal[dest])
-        {
-            bBoard.bRooks -= sqrVal[dest];
-            bBoard.bMaterialVal -= 500;
-        }
-        else if (bBoard.bQueens & sqrVal[dest])
-        {
-            bBoard.bQueens -= sqrVal[dest];
-            bBoard.bMaterialVal -= 1000;
-        }
+        if (isWhite)
+            bBoard.bMaterialVal -= pieceVals[u.capturedPiece % 6];
+        else
+            bBoard.wMaterialVal -= pieceVals[u.capturedPiece % 6];
     }
 
-    // Check what piece was moved
-    // For white pieces
-    // White pawns including promotion
-    if (bBoard.wPawns & sqrVal[curr])
-    {
-        bBoard.wPawns -= sqrVal[curr];
+    // Move the piece, changing a pawn on the last row into the promotion piece
+    bBoard.*pieceBoards[u.movedPiece] -= sqrVal[curr];
+    bBoard.key ^= zobrist.pieces[u.movedPiece][curr];
+    removePieceSquareVal(bBoard, u.movedPiece, curr);
 
-        // Check if the pawn promoted
-        if (dest/8 == 0)
-        {
-            bBoard.prevWasQuiet = false;
-
-            // If the move isn't by a computer, ask the user what piece the pawn should be promoted to
-            if (!moveIsComp)
-            {
-                string piece = getPromotionPiece();
-
-                // Check which piece the user wants the pawn to be promoted to and update material values
-                switch (piece[0])
-                {
-                    case 'n':
-                        bBoard.wKnights += sqrVal[dest];
-                        bBoard.wMaterialVal += 310;
-                        break;
-                    case 'b':
-                        bBoard.wBishops += sqrVal[dest];
-                        bBoard.wMaterialVal += 320;
-                        break;
-                    case 'r':
-                        bBoard.wRooks += sqrVal[dest];
-                        bBoard.wMaterialVal += 500;
-                        break;
-                    case 'q':
-                        bBoard.wQueens += sqrVal[dest];
-                        bBoard.wMaterialVal += 1000;
-                        break;
-                }
-            }
-            // Default is to promote to a queen
-            else
-            {
-                bBoard.wQueens += sqrVal[dest];
-                bBoard.wMaterialVal += 1000;
-            }
-        }
-        // For a regular pawn move
-        else
-        {
-             bBoard.wPawns += sqrVal[dest];
-        }
-    }
-    // White knights
-    else if (bBoard.wKnights & sqrVal[curr])
+    if (plyType(p) == PROMOTION)
     {
-        bBoard.wKnights -= sqrVal[curr];
-        bBoard.wKnights += sqrVal[dest];
-    }
-    // White bishops
-    else if (bBoard.wBishops & sqrVal[curr])
-    {
-        bBoard.wBishops -= sqrVal[curr];
-        bBoard.wBishops += sqrVal[dest];
-    }
-    // White rooks
-    else if (bBoard.wRooks & sqrVal[curr])
-    {
-        bBoard.wRooks -= sqrVal[curr];
-        bBoard.wRooks += sqrVal[dest];
-
-        // Check to see if any rooks have moved for castling
-        if (!(bBoard.wRooks & 128))
-            bBoard.wQueenSide = false;
-        if (!(bBoard.wRooks & 1))
-            bBoard.wKingSide = false;
-    }
-    // White queens
-    else if (bBoard.wQueens & sqrVal[curr])
-    {
-        bBoard.wQueens -= sqrVal[curr];
-        bBoard.wQueens += sqrVal[dest];
-    }
-    // White kings
-    else if (bBoard.wKings & sqrVal[curr])
-    {
-        bBoard.wKings -= sqrVal[curr];
-        bBoard.wKings += sqrVal[dest];
-        bBoard.wQueenSide = bBoard.wKingSide = false;
-    }
-    // For black pieces
-    // For black pawns
-    else if (bBoard.bPawns & sqrVal[curr])
-    {
-        bBoard.bPawns -= sqrVal[curr];
+        u.promotedPiece = plyPromotion(p);
 
-        // Check if the pawn promoted
-        if (dest/8 == 7)
-        {
-            bBoard.prevWasQuiet = false;
-
-            // If the move isn't by a computer, ask the user what piece the pawn should be promoted to
-            if (!moveIsComp)
-            {
-                string piece = getPromotionPiece();
-
-                // Check which piece the user wants the pawn to be promoted to and update material values
-                switch (piece[0])
-                {
-                    case 'n':
-                        bBoard.bKnights += sqrVal[dest];
-                        bBoard.bMaterialVal += 310;
-                        break;
-                    case 'b':
-                        bBoard.bBishops += sqrVal[dest];
-                        bBoard.bMaterialVal += 320;
-                        break;
-                    case 'r':
-                        bBoard.bRooks += sqrVal[dest];
-                        bBoard.bMaterialVal += 500;
-                        break;
-                    case 'q':
-                        bBoard.bQueens += sqrVal[dest];
-                        bBoard.bMaterialVal += 1000;
-                        break;
-                }
-            }
-            // Default is to promote to a queen
-            else
-            {
-                bBoard.bQueens += sqrVal[dest];
-                bBoard.bMaterialVal += 1000;
-            }
-        }
-        // For a regular pawn move
+        if (!isWhite)
+            u.promotedPiece += 6;
+
+        bBoard.*pieceBoards[u.promotedPiece] += sqrVal[dest];
+        bBoard.key ^= zobrist.pieces[u.promotedPiece][dest];
+        addPieceSquareVal(bBoard, u.promotedPiece, dest);
+        bBoard.prevWasQuiet = false;
+
+        if (isWhite)
+            bBoard.wMaterialVal += pieceVals[u.promotedPiece % 6] - pieceVals[PAWN];
         else
-        {
-            bBoard.bPawns += sqrVal[dest];
-        }
+            bBoard.bMaterialVal += pieceVals[u.promotedPiece % 6] - pieceVals[PAWN];
     }
-    // For black knights
-    else if (bBoard.bKnights & sqrVal[curr])
-    {
-        bBoard.bKnights -= sqrVal[curr];
-        bBoard.bKnights += sqrVal[dest];
-    }
-    // For black bishops
-    else if (bBoard.bBishops & sqrVal[curr])
+    else
     {
-        bBoard.bBishops -= sqrVal[curr];
-        bBoard.bBishops += sqrVal[dest];
+        bBoard.*pieceBoards[u.movedPiece] += sqrVal[dest];
+        bBoard.key ^= zobrist.pieces[u.movedPiece][dest];
+        addPieceSquareVal(bBoard, u.movedPiece, dest);
     }
-    // For black rooks
-    else if (bBoard.bRooks & sqrVal[curr])
-    {
-        bBoard.bRooks -= sqrVal[curr];
-        bBoard.bRooks += sqrVal[dest];
 
-        if (!(bBoard.bRooks & 9223372036854775808U))
-            bBoard.bQueenSide = false;
-        if (!(bBoard.bRooks & 72057594037927936))
-            bBoard.bKingSide = false;
-    }
-    // For black queens
-    else if (bBoard.bQueens & sqrVal[curr])
-    {
-        bBoard.bQueens -= sqrVal[curr];
-        bBoard.bQueens += sqrVal[dest];
-    }
-    // For black kings
-    else if (bBoard.bKings & sqrVal[curr])
+    // Move the rook as well when castling
+    if (plyType(p) == CASTLING)
     {
-        bBoard.bKings -= sqrVal[curr];
-        bBoard.bKings += sqrVal[dest];
-        bBoard.bQueenSide = bBoard.bKingSide = false;
+        int rookCurr = (dest > curr) ? curr+3 : curr-4;
+        int rookDest = (dest > curr) ? curr+1 : curr-1;
+        U64 &rooks = isWhite ? bBoard.wRooks : bBoard.bRooks;
+        int rook = isWhite ? ROOK : ROOK+6;
+
+        rooks -= sqrVal[rookCurr];
+        rooks += sqrVal[rookDest];
+        bBoard.key ^= zobrist.pieces[rook][rookCurr] ^ zobrist.pieces[rook][rookDest];
+        removePieceSquareVal(bBoard, rook, rookCurr);
+        addPieceSquareVal(bBoard, rook, rookDest);
     }
 
+    // A king or rook leaving its starting square (or a rook being captured on it) ends castling on that side
+    if (curr == 60 || curr == 56 || dest == 56)
+        bBoard.wQueenSide = false;
+    if (curr == 60 || curr == 63 || dest == 63)
+        bBoard.wKingSide = false;
+    if (curr == 4 || curr == 0 || dest == 0)
+        bBoard.bQueenSide = false;
+    if (curr == 4 || curr == 7 || dest == 7)
+        bBoard.bKingSide = false;
+
     // Update moves and the union sets
     bBoard.prevCurr = curr;
     bBoard.prevDest = dest;
     bBoard.updateUnions();
 
-    return bBoard;
+    // Add the new castling rights and en passant column to the key and change the side to move
+    bBoard.key ^= getCastlingKey(bBoard) ^ zobrist.whiteMove;
+    if (getEnPassantCol(bBoard) >= 0)
+        bBoard.key ^= zobrist.enPassant[getEnPassantCol(bBoard)];
 }
 
-// Function to update a bitboard after en passant
-bitboard updateBBoardEnPass (bitboard oldBBoard, int curr, int dest)
+// Function to take back a move made by makeMove using its undo record
+void unmakeMove (bitboard &bBoard, const undo &u)
 {
-    bitboard bBoard = oldBBoard;
-
-    // For white pawns
-    if (bBoard.wPawns & sqrVal[curr])
-    {
-        bBoard.bPawns -= sqrVal[dest+8];
-        bBoard.wPawns -= sqrVal[curr];
-        bBoard.wPawns += sqrVal[dest];
-    }
-    // For black pawns
+    // Take the piece (or the piece it promoted to) off the destination square and put it back
+    if (u.promotedPiece >= 0)
+        bBoard.*pieceBoards[u.promotedPiece] -= sqrVal[u.dest];
     else
+        bBoard.*pieceBoards[u.movedPiece] -= sqrVal[u.dest];
+
+    bBoard.*pieceBoards[u.movedPiece] += sqrVal[u.curr];
+
+    // Put back any captured piece
+    if (u.capturedPiece >= 0)
+        bBoard.*pieceBoards[u.capturedPiece] += sqrVal[u.capturedSqr];
+
+    // Put back the rook after castling
+    if (u.movedPiece % 6 == KING && absDiff(u.curr%8, u.dest%8) == 2)
     {
-        bBoard.wPawns -= sqrVal[dest-8];
-        bBoard.bPawns -= sqrVal[curr];
-        bBoard.bPawns += sqrVal[dest];
+        int rookCurr = (u.dest > u.curr) ? u.curr+3 : u.curr-4;
+        int rookDest = (u.dest > u.curr) ? u.curr+1 : u.curr-1;
+        U64 &rooks = (u.movedPiece < 6) ? bBoard.wRooks : bBoard.bRooks;
+
+        rooks -= sqrVal[rookDest];
+        rooks += sqrVal[rookCurr];
     }
 
-    // Update moves and the union sets
-    bBoard.prevCurr = curr;
-    bBoard.prevDest = dest;
+    // Restore everything else from the undo record
+    bBoard.prevCurr = u.prevCurr;
+    bBoard.prevDest = u.prevDest;
+    bBoard.wQueenSide = u.wQueenSide;
+    bBoard.wKingSide = u.wKingSide;
+    bBoard.bQueenSide = u.bQueenSide;
+    bBoard.bKingSide = u.bKingSide;
+    bBoard.wMaterialVal = u.wMaterialVal;
+    bBoard.bMaterialVal = u.bMaterialVal;
+    bBoard.mgVal = u.mgVal;
+    bBoard.egVal = u.egVal;
+    bBoard.phase = u.phase;
+    bBoard.prevWasQuiet = u.prevWasQuiet;
+    bBoard.key = u.key;
     bBoard.updateUnions();
+}
 
-    return bBoard;
+// Function to pass the move to the other side without moving a piece (a null move), which can't be
+// captured en passant after, storing what is needed to take it back in an undo record
+void makeNullMove (bitboard &bBoard, undo &u)
+{
+    u.prevCurr = bBoard.prevCurr;
+    u.prevDest = bBoard.prevDest;
+    u.key = bBoard.key;
+
+    if (getEnPassantCol(bBoard) >= 0)
+        bBoard.key ^= zobrist.enPassant[getEnPassantCol(bBoard)];
+    bBoard.key ^= zobrist.whiteMove;
+
+    bBoard.prevCurr = 0;
+    bBoard.prevDest = 0;
 }
 
-// Function to update a bitboard after castling
-bitboard updateBBoardCast (bitboard oldBBoard, int curr, int dest)
+// Function to take back a null move made by makeNullMove
+void unmakeNullMove (bitboard &bBoard, const undo &u)
 {
-    bitboard bBoard = oldBBoard;
+    bBoard.prevCurr = u.prevCurr;
+    bBoard.prevDest = u.prevDest;
+    bBoard.key = u.key;
+}
 
-    // White queenside castling
-    if (curr == 60 && dest == 58)
-    {
-        bBoard.wKings -= sqrVal[60];
-        bBoard.wKings += sqrVal[58];
-        bBoard.wRooks -= sqrVal[56];
-        bBoard.wRooks += sqrVal[59];
-    }
-    // White kingside castling
-    else if (curr == 60 && dest == 62)
-    {
-        bBoard.wKings -= sqrVal[60];
-        bBoard.wKings += sqrVal[62];
-        bBoard.wRooks -= sqrVal[63];
-        bBoard.wRooks += sqrVal[61];
-    }
-    // Black queenside castling
-    else if (curr == 4 && dest == 2)
-    {
-        bBoard.bKings -= sqrVal[4];
-        bBoard.bKings += sqrVal[2];
-        bBoard.bRooks -= sqrVal[0];
-        bBoard.bRooks += sqrVal[3];
-    }
-    // Black kingside castling
-    else if (curr == 4 && dest == 6)
+// Function to return which piece is on a square (an index into pieceBoards, or -1 if the square is blank)
+int getPieceOn (const bitboard &bBoard, int square)
+{
+    if (bBoard.blank & sqrVal[square])
+        return -1;
+
+    for (int piece = 0; piece < 12; piece++)
     {
-        bBoard.bKings -= sqrVal[4];
-        bBoard.bKings += sqrVal[6];
-        bBoard.bRooks -= sqrVal[7];
-        bBoard.bRooks += sqrVal[5];
+        if (bBoard.*pieceBoards[piece] & sqrVal[square])
+            return piece;
     }
 
-    // Update moves and the union sets
-    bBoard.prevCurr = curr;
-    bBoard.prevDest = dest;
-    bBoard.updateUnions();
-
-    return bBoard;
+    return -1;
 }
 
 // Function to return a 64-bit integer of all the pawn moves for a particular square
-U64 getPawnMoves (bitboard bBoard, int square)
+U64 getPawnMoves (const bitboard &bBoard, int square)
 {
     // For white pawns
     if (bBoard.wPieces & sqrVal[square])
@@ -721,24 +769,34 @@ U64 getPawnMoves (bitboard bBoard, int square)
 }
 
 // Function to return a 64-bit integer, where an en passant capture could occur, for a particular square
-U64 getEnPassant (bitboard bBoard, int square)
+U64 getEnPassant (const bitboard &bBoard, int square)
 {
     // Ensure that the previous move was a pawn advance of 2 squares
     if (absDiff(bBoard.prevCurr/8, bBoard.prevDest/8) == 2 && ((bBoard.wPawns | bBoard.bPawns) & sqrVal[bBoard.prevDest])
         && (square/8 == bBoard.prevDest/8) && absDiff (square%8, bBoard.prevDest%8) == 1)
     {
-        // For white pawns - ensure the king isn't in check
-        if (bBoard.prevDest/8 == 3 && !isInCheck(bBoard, getWKingLoc(bBoard)))
+        // For white pawns capturing a black pawn (whether the king is left in check is tested later)
+        if (bBoard.prevDest/8 == 3 && (bBoard.wPawns & sqrVal[square]) && (bBoard.bPawns & sqrVal[bBoard.prevDest]))
             return sqrVal[bBoard.prevDest-8];
-        // For black pawns - ensure the king isn't in check
-        else if (bBoard.prevDest/8 == 4 && !isInCheck(bBoard, getBKingLoc(bBoard)))
+        // For black pawns capturing a white pawn
+        else if (bBoard.prevDest/8 == 4 && (bBoard.bPawns & sqrVal[square]) && (bBoard.wPawns & sqrVal[bBoard.prevDest]))
             return sqrVal[bBoard.prevDest+8];
     }
     return 0;
 }
 
+// Function to return the column where the previous move allows en passant (-1 if it doesn't)
+int getEnPassantCol (const bitboard &bBoard)
+{
+    // The previous move must have been a pawn moving 2 squares
+    if (absDiff(bBoard.prevCurr/8, bBoard.prevDest/8) == 2 && ((bBoard.wPawns | bBoard.bPawns) & sqrVal[bBoard.prevDest]))
+        return bBoard.prevDest%8;
+
+    return -1;
+}
+
 // Function to return a 64-bit integer of all the knight moves for a particular square
-U64 getKnightMoves (bitboard bBoard, int square)
+U64 getKnightMoves (const bitboard &bBoard, int square)
 {
     // For white knights
     if (bBoard.wPieces & sqrVal[square])
@@ -750,94 +808,34 @@ U64 getKnightMoves (bitboard bBoard, int square)
 
 
 // Function to return a 64-bit integer of all the bishop moves for a particular square
-U64 getBishopMoves (bitboard bBoard, int square)
+U64 getBishopMoves (const bitboard &bBoard, int square)
 {
-    U64 deg45Moves, deg135Moves, deg225Moves, deg315Moves, blankOrEnemy;
-
-    // Determine where the enemy pieces are
+    // Look up the attacked squares and remove the ones with friendly pieces
     if (bBoard.wPieces & sqrVal[square])
-        blankOrEnemy = bBoard.blank | bBoard.bPieces;
+        return bishopAttacks(bBoard.pieces, square) & (bBoard.blank | bBoard.bPieces);
     else
-        blankOrEnemy = bBoard.blank | bBoard.wPieces;
-
-    // Get the first blocking piece
-    deg45Moves = deg45Dir[square] & bBoard.pieces;
-
-    // Get the blocked squares
-    deg45Moves = deg45Dir[square] & ((deg45Moves<<7) | (deg45Moves<<14) | (deg45Moves<<21) | (deg45Moves<<28) | (deg45Moves<<35) | (deg45Moves<<42));
-
-    // Get the unblocked squares
-    deg45Moves = (deg45Moves ^ deg45Dir[square]) & blankOrEnemy;
-
-    // Repeat process for the other directions
-    deg135Moves = deg135Dir[square] & bBoard.pieces;
-    deg135Moves = deg135Dir[square] & ((deg135Moves<<9) | (deg135Moves<<18) | (deg135Moves<<27) | (deg135Moves<<36) | (deg135Moves<<45) | (deg135Moves<<54));
-    deg135Moves = (deg135Moves ^ deg135Dir[square]) & blankOrEnemy;
-
-    deg225Moves = deg225Dir[square] & bBoard.pieces;
-    deg225Moves = deg225Dir[square] & ((deg225Moves>>7) | (deg225Moves>>14) | (deg225Moves>>21) | (deg225Moves>>28) | (deg225Moves>>35) | (deg225Moves>>42));
-    deg225Moves = (deg225Moves ^ deg225Dir[square]) & blankOrEnemy;
-
-    deg315Moves = deg315Dir[square] & bBoard.pieces;
-    deg315Moves = deg315Dir[square] & ((deg315Moves>>9) | (deg315Moves>>18) | (deg315Moves>>27) | (deg315Moves>>36) | (deg315Moves>>45) | (deg315Moves>>54));
-    deg315Moves = (deg315Moves ^ deg315Dir[square]) & blankOrEnemy;
-
-    return deg45Moves | deg135Moves | deg225Moves | deg315Moves;
+        return bishopAttacks(bBoard.pieces, square) & (bBoard.blank | bBoard.wPieces);
 }
 
 // Function to return a 64-bit integer of all the rook moves for
 // a particular square
-U64 getRookMoves (bitboard bBoard, int square)
+U64 getRookMoves (const bitboard &bBoard, int square)
 {
-    U64 rightMoves, leftMoves, upMoves, downMoves, blankOrEnemy;
-
-    // Determine where the enemy pieces are
+    // Look up the attacked squares and remove the ones with friendly pieces
     if (bBoard.wPieces & sqrVal[square])
-        blankOrEnemy = bBoard.blank | bBoard.bPieces;
+        return rookAttacks(bBoard.pieces, square) & (bBoard.blank | bBoard.bPieces);
     else
-        blankOrEnemy = bBoard.blank | bBoard.wPieces;
-
-    // Get the first blocking piece
-    rightMoves = rightDir[square] & bBoard.pieces;
-
-    // Get the blocked squares
-    rightMoves = rightDir[square] & ((rightMoves>>1) | (rightMoves>>2) |
-                                     (rightMoves>>3) | (rightMoves>>4) |
-                                     (rightMoves>>5) | (rightMoves>>6));
-
-    // Get the unblocked squares
-    rightMoves = (rightMoves ^ rightDir[square]) & blankOrEnemy;
-
-    // Repeat process for the other directions
-    leftMoves = leftDir[square] & bBoard.pieces;
-    leftMoves = leftDir[square] & ((leftMoves<<1) | (leftMoves<<2) |
-                                   (leftMoves<<3) | (leftMoves<<4) |
-                                   (leftMoves<<5) | (leftMoves<<6));
-    leftMoves = (leftMoves ^ leftDir[square]) & blankOrEnemy;
-
-    upMoves = upDir[square] & bBoard.pieces;
-    upMoves = upDir[square] & ((upMoves<<8) | (upMoves<<16) |
-                               (upMoves<<24) | (upMoves<<32) |
-                               (upMoves<<40) | (upMoves<<48));
-    upMoves = (upMoves ^ upDir[square]) & blankOrEnemy;
-
-    downMoves = downDir[square] & bBoard.pieces;
-    downMoves = downDir[square] & ((downMoves>>8) | (downMoves>>16) |
-                                   (downMoves>>24) | (downMoves>>32) |
-                                   (downMoves>>40) | (downMoves>>48));
-    downMoves = (downMoves ^ downDir[square]) & blankOrEnemy;
-
-    return rightMoves | leftMoves | upMoves | downMoves;
+        return rookAttacks(bBoard.pieces, square) & (bBoard.blank | bBoard.wPieces);
 }
 
 // Function to return a 64-bit integer of king moves
-U64 getQueenMoves (bitboard bBoard, int square)
+U64 getQueenMoves (const bitboard &bBoard, int square)
 {
     return getBishopMoves(bBoard, square) | getRookMoves(bBoard, square);
 }
 
 // Function to return a 64-bit integer of king moves
-U64 getKingMoves (bitboard bBoard, int square)
+U64 getKingMoves (const bitboard &bBoard, int square)
 {
     // For white king
     if (bBoard.wPieces & sqrVal[square])
@@ -847,81 +845,54 @@ U64 getKingMoves (bitboard bBoard, int square)
         return kingDir[square] & (bBoard.wPieces | bBoard.blank);
 }
 
-// Function to return a 64-bit integer of all the castling moves
-U64 getCastlingMoves (bitboard bBoard, int square)
+// Function to return a 64-bit integer of all the castling moves, given every square the opponent attacks
+U64 getCastlingMoves (const bitboard &bBoard, int square, U64 enemyAttacks)
 {
     U64 moves = 0;
 
     // White king castling
     if (square == 60)
     {
-        // Make sure that there are no blocking pieces to the queenside
-        if (bBoard.wQueenSide && !(bBoard.pieces & 112))
-        {
-            // Pretend that there are kings at the squares where it castles through
-            bBoard.wKings += 48;
-            bBoard.updateUnions();
-
-            // Ensure that the king does not castle through check
-            if (!isInCheck(bBoard, 58) && !isInCheck(bBoard, 59) && !isInCheck(bBoard, 60))
-                moves += 32;
-            bBoard.wKings -= 48;
-            bBoard.updateUnions();
-        }
-        // Make sure that there are no blocking pieces to the kingside
-        if (bBoard.wKingSide && !(bBoard.pieces & 6))
-        {
-            // Pretend that there are kings at the squares where it castles through
-            bBoard.wKings += 6;
-            bBoard.updateUnions();
-
-            // Ensure that the king does not castle through check
-            if (!isInCheck(bBoard, 60) && !isInCheck(bBoard, 61) && !isInCheck(bBoard, 62))
-                moves += 2;
-        }
+        // Make sure that there are no blocking pieces and that the king doesn't castle out of or through check
+        if (bBoard.wQueenSide && !(bBoard.pieces & 112) && !(enemyAttacks & (sqrVal[58] | sqrVal[59] | sqrVal[60])))
+            moves |= sqrVal[58];
+        if (bBoard.wKingSide && !(bBoard.pieces & 6) && !(enemyAttacks & (sqrVal[60] | sqrVal[61] | sqrVal[62])))
+            moves |= sqrVal[62];
     }
     // Black king castling
     else if (square == 4)
     {
-        // Make sure that there are no blocking pieces to the queenside
-        if (bBoard.bQueenSide && !(bBoard.pieces & 8070450532247928832))
-        {
-            // Pretend that there are kings at the squares where it castles through
-            bBoard.bKings += 3458764513820540928;
-            bBoard.updateUnions();
-
-            // Ensure that the king does not castle through check
-            if (!isInCheck(bBoard, 2) && !isInCheck(bBoard, 3) && !isInCheck(bBoard, 4))
-                moves += 2305843009213693952;
-            bBoard.wKings -= 3458764513820540928;
-            bBoard.updateUnions();
-        }
-        // Make sure that there are no blocking pieces to the kingside
-        if (bBoard.bKingSide && !(bBoard.pieces & 432345564227567616))
-        {
-            // Pretend that there are kings at the squares where it castles through
-            bBoard.bKings += 432345564227567616;
-            bBoard.updateUnions();
-
-            // Ensure that the king does not castle through check
-            if (!isInCheck(bBoard, 4) && !isInCheck(bBoard, 5) && !isInCheck(bBoard, 6))
-                moves += 144115188075855872;
-        }
+        if (bBoard.bQueenSide && !(bBoard.pieces & 8070450532247928832) && !(enemyAttacks & (sqrVal[2] | sqrVal[3] | sqrVal[4])))
+            moves |= sqrVal[2];
+        if (bBoard.bKingSide && !(bBoard.pieces & 432345564227567616) && !(enemyAttacks & (sqrVal[4] | sqrVal[5] | sqrVal[6])))
+            moves |= sqrVal[6];
     }
 
     return moves;
 }
 
 // Function to get the location of a white king
-int getWKingLoc (bitboard bBoard)
+int getWKingLoc (const bitboard &bBoard)
 {
-    return 63-log2(bBoard.wKings);
+    return firstSquare(bBoard.wKings);
 }
 
 // Function to get the location of a black king
-int getBKingLoc (bitboard bBoard)
+int getBKingLoc (const bitboard &bBoard)
 {
-    return 63-log2(bBoard.bKings);
+    return firstSquare(bBoard.bKings);
+}
+
+// Function to return the result if the side to move is checkmated or stalemated (NORESULT if it has a move)
+int getGameResult (const bitboard &bBoard, bool whiteMove)
+{
+    if (areLegalMoves(bBoard, whiteMove))
+        return NORESULT;
+
+    if (isInCheck(bBoard, whiteMove ? getWKingLoc(bBoard) : getBKingLoc(bBoard)))
+        return whiteMove ? BLACKWINS : WHITEWINS;
+
+    return DRAW;
 }
 
 // Initialize both boards
@@ -1076,42 +1047,28 @@ void svecToBitboard (bitboard &bBoard, svec sBoard)
     if (!(bBoard.bKings & sqrVal[4]))
         bBoard.bQueenSide = bBoard.bKingSide = false;
 
-    // Update the bitboard's union 64-bit integers
+    // Update the bitboard's union 64-bit integers and calculate the hash key (white moves first)
+    // and the piece-square values
     bBoard.updateUnions();
+    bBoard.key = calcZobristKey(bBoard, true);
+    calcPieceSquareVals(bBoard);
 }
 
 // Function to convert a bitboard into a string vector
-void bitBoardToSVec (bitboard bBoard, svec &sBoard)
+void bitBoardToSVec (const bitboard &bBoard, svec &sBoard)
 {
-    // Go through all the squares to see what piece occupies that square
+    // Blank every square, then go through the squares of each type of piece
     for (int i = 0; i < 64; i++)
+        sBoard[i/8][i%8] = ' ';
+
+    for (int piece = 0; piece < 12; piece++)
     {
-        if (bBoard.wPawns & sqrVal[i])
-            sBoard[i/8][i%8] = 'P';
-        else if (bBoard.wKnights & sqrVal[i])
-            sBoard[i/8][i%8] = 'N';
-        else if (bBoard.wBishops & sqrVal[i])
-            sBoard[i/8][i%8] = 'B';
-        else if (bBoard.wRooks & sqrVal[i])
-            sBoard[i/8][i%8] = 'R';
-        else if (bBoard.wQueens & sqrVal[i])
-            sBoard[i/8][i%8] = 'Q';
-        else if (bBoard.wKings & sqrVal[i])
-            sBoard[i/8][i%8] = 'K';
-        else if (bBoard.bPawns & sqrVal[i])
-            sBoard[i/8][i%8] = 'p';
-        else if (bBoard.bKnights & sqrVal[i])
-            sBoard[i/8][i%8] = 'n';
-        else if (bBoard.bBishops & sqrVal[i])
-            sBoard[i/8][i%8] = 'b';
-        else if (bBoard.bRooks & sqrVal[i])
-            sBoard[i/8][i%8] = 'r';
-        else if (bBoard.bQueens & sqrVal[i])
-            sBoard[i/8][i%8] = 'q';
-        else if (bBoard.bKings & sqrVal[i])
-            sBoard[i/8][i%8] = 'k';
-        else
-            sBoard[i/8][i%8] = ' ';
+        U64 squares = bBoard.*pieceBoards[piece];
+        while (squares)
+        {
+            int i = popSquare(squares);
+            sBoard[i/8][i%8] = "PNBRQKpnbrqk"[piece];
+        }
     }
 }
 
@@ -1130,6 +1087,22 @@ void squareToMove (int curr, int dest)
     cout << (char)((curr%8)+97) << 8 - curr/8 << " " << (char)((dest%8)+97) << 8 - dest/8 << endl << endl;
 }
 
+// Convert a move into a string in coordinate notation (e.g. e2e4)
+string plyToString (ply move)
+{
+    string s = "a1a1";
+    s[0] = (char)((plyCurr(move)%8)+97);
+    s[1] = (char)(56 - plyCurr(move)/8);
+    s[2] = (char)((plyDest(move)%8)+97);
+    s[3] = (char)(56 - plyDest(move)/8);
+
+    // Add the letter of the piece for promotions (e.g. e7e8q)
+    if (plyType(move) == PROMOTION)
+        s += "pnbrqk"[plyPromotion(move)];
+
+    return s;
+}
+
 // Checks to see if the inputted move contains valid chess coordinates
 bool isValidInput (string input)
 {
@@ -1149,7 +1122,7 @@ bool isValidInput (string input)
 }
 
 // Function to update a bitboard after castling
-bool isRightColour (bitboard board, int curr, int moveNum)
+bool isRightColour (const bitboard &board, int curr, int moveNum)
 {
     // Ensure that the square is not blank
     if (board.pieces & sqrVal[curr])
@@ -1181,235 +1154,3 @@ string getPromotionPiece ()
     }
     return piece;
 }
-
-// Functions to read the textfile containing various calculated 64-bit integers
-void getDirections()
-{
-    ifstream inFile;
-    string line;
-    string fileName = "storedU64s.txt";
-
-    // Open text file
-    while (true)
-    {
-
-        inFile.open (fileName.c_str(), ifstream::in);
-
-        // Make sure file is openable
-        if (!inFile.is_open())
-        {
-            cout << "Enter the name of the textfile containing stored U64s: ";
-            getline(cin, fileName);
-        }
-        // Exit if the file can open
-        else
-            break;
-    }
-
-    // Read text file
-    // Input the value of each square
-    int numInputted = 0;
-    while (numInputted < 64)
-    {
-        getline (inFile, line);
-        if (line.size() > 0 && line[0] != '/')
-        {
-            sqrVal[numInputted] = strtoull (line.c_str(), NULL, 10);
-            numInputted++;
-        }
-    }
-
-    // Input the white pawn moves of 1 square
-    numInputted = 0;
-    while (numInputted < 64)
-    {
-        getline (inFile, line);
-        if (line.size() > 0 && line[0] != '/')
-        {
-            wPawn1Dir[numInputted] = strtoull (line.c_str(), NULL, 2);
-            numInputted++;
-        }
-    }
-
-    // Input the white pawn moves of 2 squares
-    numInputted = 0;
-    while (numInputted < 64)
-    {
-        getline (inFile, line);
-        if (line.size() > 0 && line[0] != '/')
-        {
-            wPawn2Dir[numInputted] = strtoull (line.c_str(), NULL, 2);
-            numInputted++;
-        }
-    }
-
-    // Input the white pawn captures
-    numInputted = 0;
-    while (numInputted < 64)
-    {
-        getline (inFile, line);
-        if (line.size() > 0 && line[0] != '/')
-        {
-            wPawnCapDir[numInputted] = strtoull (line.c_str(), NULL, 2);
-            numInputted++;
-        }
-    }
-
-    // Input the black pawn moves of 1 square
-    numInputted = 0;
-    while (numInputted < 64)
-    {
-        getline (inFile, line);
-        if (line.size() > 0 && line[0] != '/')
-        {
-            bPawn1Dir[numInputted] = strtoull (line.c_str(), NULL, 2);
-            numInputted++;
-        }
-    }
-
-    // Input the black pawn moves of 2 squares
-    numInputted = 0;
-    while (numInputted < 64)
-    {
-        getline (inFile, line);
-        if (line.size() > 0 && line[0] != '/')
-        {
-            bPawn2Dir[numInputted] = strtoull (line.c_str(), NULL, 2);
-            numInputted++;
-        }
-    }
-
-    // Input the black pawn captures
-    numInputted = 0;
-    while (numInputted < 64)
-    {
-        getline (inFile, line);
-        if (line.size() > 0 && line[0] != '/')
-        {
-            bPawnCapDir[numInputted] = strtoull (line.c_str(), NULL, 2);
-            numInputted++;
-        }
-    }
-
-    // Input the knight moves
-    numInputted = 0;
-    while (numInputted < 64)
-    {
-        getline (inFile, line);
-        if (line.size() > 0 && line[0] != '/')
-        {
-            knightDir[numInputted] = strtoull (line.c_str(), NULL, 2);
-            numInputted++;
-        }
-    }
-
-    // Input the king moves
-    numInputted = 0;
-    while (numInputted < 64)
-    {
-        getline (inFile, line);
-        if (line.size() > 0 && line[0] != '/')
-        {
-            kingDir[numInputted] = strtoull (line.c_str(), NULL, 2);
-            numInputted++;
-        }
-    }
-
-    // Input the squares that are to the right of each square
-    numInputted = 0;
-    while (numInputted < 64)
-    {
-        getline (inFile, line);
-        if (line.size() > 0 && line[0] != '/')
-        {
-            rightDir[numInputted] = strtoull (line.c_str(), NULL, 2);
-            numInputted++;
-        }
-    }
-
-    // Input the squares that are to the left of each square
-    numInputted = 0;
-    while (numInputted < 64)
-    {
-        getline (inFile, line);
-        if (line.size() > 0 && line[0] != '/')
-        {
-            leftDir[numInputted] = strtoull (line.c_str(), NULL, 2);
-            numInputted++;
-        }
-    }
-
-    // Input the squares that are above each square
-    numInputted = 0;
-    while (numInputted < 64)
-    {
-        getline (inFile, line);
-        if (line.size() > 0 && line[0] != '/')
-        {
-            upDir[numInputted] = strtoull (line.c_str(), NULL, 2);
-            numInputted++;
-        }
-    }
-
-    // Input the squares that are below each square
-    numInputted = 0;
-    while (numInputted < 64)
-    {
-        getline (inFile, line);
-        if (line.size() > 0 && line[0] != '/')
-        {
-            downDir[numInputted] = strtoull (line.c_str(), NULL, 2);
-            numInputted++;
-        }
-    }
-
-    // Input the squares that are to the 45 degrees from each square
-    numInputted = 0;
-    while (numInputted < 64)
-    {
-        getline (inFile, line);
-        if (line.size() > 0 && line[0] != '/')
-        {
-            deg45Dir[numInputted] = strtoull (line.c_str(), NULL, 2);
-            numInputted++;
-        }
-    }
-
-    // Input the squares that are to the 135 degrees from each square
-    numInputted = 0;
-    while (numInputted < 64)
-    {
-        getline (inFile, line);
-        if (line.size() > 0 && line[0] != '/')
-        {
-            deg135Dir[numInputted] = strtoull (line.c_str(), NULL, 2);
-            numInputted++;
-        }
-    }
-
-    // Input the squares that are to the 225 degrees from each square
-    numInputted = 0;
-    while (numInputted < 64)
-    {
-        getline (inFile, line);
-        if (line.size() > 0 && line[0] != '/')
-        {
-            deg225Dir[numInputted] = strtoull (line.c_str(), NULL, 2);
-            numInputted++;
-        }
-    }
-
-    // Input the squares that are to the 315 degrees from each square
-    numInputted = 0;
-    while (numInputted < 64)
-    {
-        getline (inFile, line);
-        if (line.size() > 0 && line[0] != '/')
-        {
-            deg315Dir[numInputted] = strtoull (line.c_str(), NULL, 2);
-            numInputted++;
-        }
-    }
-
-    inFile.close();
-}
@@ -8,6 +8,8 @@
 
 #include <vector>
 #include <string>
+#include <array>
+#include "bit_utils.h"
 
 using namespace std;
 
@@ -53,61 +55,244 @@ struct bitboard
     int wMaterialVal = 0;
     int bMaterialVal = 0;
 
+    // The piece-square values of white minus black's in the middlegame and in the endgame,
+    // and the phase of the game that decides how the two are blended (see piece_square_tables.h)
+    int mgVal = 0;
+    int egVal = 0;
+    int phase = 0;
+
     // Stores whether the previous move resulted in a change in material
     bool prevWasQuiet = true;
 
+    // Zobrist hash key of the position, including the side to move (updated by makeMove)
+    U64 key = 0;
+
     // Function that updates the unions as declared earlier
     void updateUnions ();
 };
 
-// Structure for a ply
-struct ply
+// Pointers to the 64-bit integer of each type of piece (white pawns to kings, then black pawns to kings)
+constexpr U64 bitboard::* pieceBoards[12] =
 {
-    int curr = 0;
-    int dest = 0;
+    &bitboard::wPawns, &bitboard::wKnights, &bitboard::wBishops, &bitboard::wRooks, &bitboard::wQueens, &bitboard::wKings,
+    &bitboard::bPawns, &bitboard::bKnights, &bitboard::bBishops, &bitboard::bRooks, &bitboard::bQueens, &bitboard::bKings
+};
+
+// Types of pieces (adding 6 gives the index of a black piece in pieceBoards)
+enum pieceType {PAWN, KNIGHT, BISHOP, ROOK, QUEEN, KING};
+
+// The material value of each type of piece
+constexpr int pieceVals[6] = {100, 310, 320, 500, 1000, 0};
+
+// Struct storing everything needed to take back a move made in place
+struct undo
+{
+    // The move and the pieces involved (indices into pieceBoards, -1 if there isn't one)
+    int curr;
+    int dest;
+    int movedPiece;
+    int capturedPiece;
+    int capturedSqr;
+    int promotedPiece;
+
+    // The state of the bitboard before the move
+    int prevCurr;
+    int prevDest;
+    bool wQueenSide;
+    bool wKingSide;
+    bool bQueenSide;
+    bool bKingSide;
+    int wMaterialVal;
+    int bMaterialVal;
+    int mgVal;
+    int egVal;
+    int phase;
+    bool prevWasQuiet;
+    U64 key;
+};
+
+// A ply packed into 16 bits
+// Bits 0-5 are the current square, bits 6-11 are the destination square,
+// bits 12-13 are the promotion piece (knight to queen) and bits 14-15 are the type of move
+typedef unsigned short ply;
+
+// Types of plies
+enum {NORMAL, PROMOTION, ENPASSANT, CASTLING};
+
+// Results of a game
+enum {NORESULT, WHITEWINS, BLACKWINS, DRAW};
+
+// Functions to pack and unpack plies
+inline ply makePly (int curr, int dest, int type = NORMAL, int promotion = KNIGHT)
+{
+    return (ply)(curr | (dest << 6) | ((promotion - KNIGHT) << 12) | (type << 14));
+}
+
+inline int plyCurr (ply p)
+{
+    return p & 63;
+}
+
+inline int plyDest (ply p)
+{
+    return (p >> 6) & 63;
+}
+
+inline int plyPromotion (ply p)
+{
+    return ((p >> 12) & 3) + KNIGHT;
+}
+
+inline int plyType (ply p)
+{
+    return p >> 14;
+}
+
+// The most legal moves any position can have is 218
+#define MAXMOVES 256
+
+// List of plies with a fixed capacity, so that it can live on the stack and never allocates memory
+struct plyList
+{
+    ply plies[MAXMOVES];
+    int size = 0;
+
+    // Function to add a ply to the end of the list
+    void add (ply p)
+    {
+        plies[size++] = p;
+    }
+
+    ply &operator[] (int i)
+    {
+        return plies[i];
+    }
 };
 
 // The rest of the typedefs
 typedef vector <string> svec;
-typedef vector <ply> plyvec;
+
+// A table with a 64-bit integer for every square
+typedef array <U64, 64> sqrTable;
+
+// Function to return the value of a square given its row and column (0 if it is off the board)
+// Square 0 is a8 in the top left corner and has the highest bit, square 63 is h1 and has the lowest bit
+constexpr U64 rowColVal (int row, int col)
+{
+    if (row < 0 || row > 7 || col < 0 || col > 7)
+        return 0;
+    return 1ULL << (63 - (row*8 + col));
+}
+
+// Function to build a table of the squares reached by repeating a step (in rows and columns) up to a number of times
+// Only squares whose row is between minRow and maxRow get any moves
+constexpr sqrTable makeRayTable (int rowStep, int colStep, int maxSteps, int minRow = 0, int maxRow = 7)
+{
+    sqrTable table {};
+
+    for (int square = 0; square < 64; square++)
+    {
+        if (square/8 < minRow || square/8 > maxRow)
+            continue;
+
+        for (int i = 1; i <= maxSteps; i++)
+            table[square] |= rowColVal(square/8 + i*rowStep, square%8 + i*colStep);
+    }
+
+    return table;
+}
+
+// Function to build a table of the squares reached by making any one of a list of jumps (in rows and columns)
+// Only squares whose row is between minRow and maxRow get any moves
+template <int numSteps>
+constexpr sqrTable makeJumpTable (const int (&steps)[numSteps][2], int minRow = 0, int maxRow = 7)
+{
+    sqrTable table {};
+
+    for (int square = 0; square < 64; square++)
+    {
+        if (square/8 < minRow || square/8 > maxRow)
+            continue;
+
+        for (int i = 0; i < numSteps; i++)
+            table[square] |= rowColVal(square/8 + steps[i][0], square%8 + steps[i][1]);
+    }
+
+    return table;
+}
+
+// The jumps that knights, kings and pawn captures can make
+constexpr int knightSteps[8][2] = {{-2, -1}, {-2, 1}, {-1, -2}, {-1, 2}, {1, -2}, {1, 2}, {2, -1}, {2, 1}};
+constexpr int kingSteps[8][2] = {{-1, -1}, {-1, 0}, {-1, 1}, {0, -1}, {0, 1}, {1, -1}, {1, 0}, {1, 1}};
+constexpr int wPawnCapSteps[2][2] = {{-1, -1}, {-1, 1}};
+constexpr int bPawnCapSteps[2][2] = {{1, -1}, {1, 1}};
 
 // Arrays of the value of each square and a bitboards of where all the pieces can move to from each square
-extern U64 sqrVal[64];
-extern U64 wPawn1Dir[64], wPawn2Dir[64], wPawnCapDir[64], bPawn1Dir[64], bPawn2Dir[64], bPawnCapDir[64], knightDir[64], kingDir[64];
-extern U64 rightDir[64], leftDir[64], upDir[64], downDir[64], deg45Dir[64], deg135Dir[64], deg225Dir[64], deg315Dir[64];
+// (all of them are calculated at compile time)
+constexpr sqrTable sqrVal = makeRayTable(0, 0, 1);
+constexpr sqrTable wPawn1Dir = makeRayTable(-1, 0, 1, 1, 6);
+constexpr sqrTable wPawn2Dir = makeRayTable(-2, 0, 1, 6, 6);
+constexpr sqrTable wPawnCapDir = makeJumpTable(wPawnCapSteps);
+constexpr sqrTable bPawn1Dir = makeRayTable(1, 0, 1, 1, 6);
+constexpr sqrTable bPawn2Dir = makeRayTable(2, 0, 1, 1, 1);
+constexpr sqrTable bPawnCapDir = makeJumpTable(bPawnCapSteps);
+constexpr sqrTable knightDir = makeJumpTable(knightSteps);
+constexpr sqrTable kingDir = makeJumpTable(kingSteps);
+constexpr sqrTable rightDir = makeRayTable(0, 1, 7);
+constexpr sqrTable leftDir = makeRayTable(0, -1, 7);
+constexpr sqrTable upDir = makeRayTable(-1, 0, 7);
+constexpr sqrTable downDir = makeRayTable(1, 0, 7);
+constexpr sqrTable deg45Dir = makeRayTable(-1, 1, 7);
+constexpr sqrTable deg135Dir = makeRayTable(-1, -1, 7);
+constexpr sqrTable deg225Dir = makeRayTable(1, -1, 7);
+constexpr sqrTable deg315Dir = makeRayTable(1, 1, 7);
 
 // Move checking functions
 void twoPlayerGame ();
-plyvec getLegalMoves (bitboard bBoard, bool whiteMove);
-bool areLegalMoves (bitboard bBoard, bool whiteMove);
-bool isLegalMove (bitboard bBoard, int curr, int dest);
-bool isInCheck (bitboard bBoard, int square);
-bitboard updateBitboard (bitboard oldBBoard, int curr, int dest, bool moveIsComp);
-bitboard updateBBoardEnPass (bitboard oldBBoard, int curr, int dest);
-bitboard updateBBoardCast (bitboard oldBBoard, int curr, int dest);
-U64 getPawnMoves (bitboard bBoard, int square);
-U64 getEnPassant (bitboard bBoard, int square);
-U64 getKnightMoves (bitboard bBoard, int square);
-U64 getBishopMoves (bitboard bBoard, int square);
-U64 getRookMoves (bitboard bBoard, int square);
-U64 getQueenMoves (bitboard bBoard, int square);
-U64 getKingMoves (bitboard bBoard, int square);
-U64 getCastlingMoves (bitboard bBoard, int square);
-int getWKingLoc (bitboard bBoard);
-int getBKingLoc (bitboard bBoard);
+void getLegalMoves (const bitboard &bBoard, bool whiteMove, plyList &legalMoves);
+void getTacticalMoves (const bitboard &bBoard, bool whiteMove, plyList &tacticalMoves);
+void generateMoves (const bitboard &bBoard, bool whiteMove, plyList &legalMoves, bool tacticalOnly, U64 checkers);
+void addMoves (plyList &moves, int curr, U64 dests, int type = NORMAL);
+void addPawnMoves (plyList &moves, U64 dests, int offset, int curr = 0);
+U64 getPinned (const bitboard &bBoard, int king, bool whiteMove);
+U64 attackersTo (const bitboard &bBoard, int square, U64 occupancy);
+U64 attackedBy (const bitboard &bBoard, bool byWhite, U64 occupancy);
+bool areLegalMoves (const bitboard &bBoard, bool whiteMove);
+bool isLegalMove (const bitboard &bBoard, int curr, int dest);
+U64 getCheckers (const bitboard &bBoard, bool whiteMove);
+bool isInCheck (const bitboard &bBoard, int square);
+bitboard updateBitboard (const bitboard &oldBBoard, int curr, int dest, bool moveIsComp);
+void makeMove (bitboard &bBoard, ply p, undo &u);
+ply squaresToPly (const bitboard &bBoard, int curr, int dest, char promotion);
+void unmakeMove (bitboard &bBoard, const undo &u);
+void makeNullMove (bitboard &bBoard, undo &u);
+void unmakeNullMove (bitboard &bBoard, const undo &u);
+int getPieceOn (const bitboard &bBoard, int square);
+U64 getPawnMoves (const bitboard &bBoard, int square);
+U64 getEnPassant (const bitboard &bBoard, int square);
+int getEnPassantCol (const bitboard &bBoard);
+U64 getKnightMoves (const bitboard &bBoard, int square);
+U64 getBishopMoves (const bitboard &bBoard, int square);
+U64 getRookMoves (const bitboard &bBoard, int square);
+U64 getQueenMoves (const bitboard &bBoard, int square);
+U64 getKingMoves (const bitboard &bBoard, int square);
+U64 getCastlingMoves (const bitboard &bBoard, int square, U64 enemyAttacks);
+int getWKingLoc (const bitboard &bBoard);
+int getBKingLoc (const bitboard &bBoard);
+int getGameResult (const bitboard &bBoard, bool whiteMove);
 
 // Declare utility functions
 void initBoard (svec &sBoard);
 void displayBoard (svec board);
 void displayU64 (U64 n);
 void svecToBitboard (bitboard &bBoard, svec sBoard);
-void bitBoardToSVec (bitboard bBoard, svec &sBoard);
+void bitBoardToSVec (const bitboard &bBoard, svec &sBoard);
 void stringToSquare (string input, int &curr, int &dest);
 void squareToMove (int curr, int dest);
+string plyToString (ply move);
 bool isValidInput (string input);
-bool isRightColour (bitboard board, int curr, int moveNum);
+bool isRightColour (const bitboard &board, int curr, int moveNum);
 int absDiff (int a, int b);
 string getPromotionPiece ();
-void getDirections ();
 
 #endif // LEGAL_MOVES_H_INCLUDED
@@ -0,0 +1,171 @@
+/// magics.cpp
+///
+/// Willie Lei
+/// Magic bitboard (and pext) lookup tables for the attacks of bishops and rooks.
+
+#include "magics.h"
+
+using namespace std;
+
+// Magic lookup data for every square and the tables all the attack sets are stored in
+magic bishopMagics[64];
+magic rookMagics[64];
+U64 bishopTable[5248];
+U64 rookTable[102400];
+U64 sqrsBetween[64][64];
+U64 sqrsInLine[64][64];
+bool usePext = false;
+
+// Magic numbers for each square, found with a trial and error search
+// (each maps every possible blocker arrangement to an index with no harmful collisions)
+const U64 bishopMagicNums[64] =
+{
+    0x10102002004A1420ULL, 0x24002220020A0044ULL, 0x00024C0810D00080ULL, 0x0111208244209200ULL,
+    0x01A0106010208844ULL, 0x0810000026211008ULL, 0x1030412401180820ULL, 0x0028208200A02020ULL,
+    0x0002100222104020ULL, 0x0078200112420300ULL, 0x0040043050024000ULL, 0x0004422044242000ULL,
+    0x5220200084040600ULL, 0x10806206010C8110ULL, 0x0802120884041610ULL, 0x8040480808088100ULL,
+    0x0002244102023C20ULL, 0x000284040488C410ULL, 0x0040080830400020ULL, 0x8004088100400400ULL,
+    0x28C0202018000104ULL, 0x0000104430016804ULL, 0x390C108805000800ULL, 0x108C108864220810ULL,
+    0x0001411100020040ULL, 0x007000C202208200ULL, 0x1001011200410800ULL, 0x8009010400060020ULL,
+    0x0000202020080080ULL, 0x3004024900080208ULL, 0x8114100D00068C00ULL, 0x0142500480C10804ULL,
+    0x0000430000410840ULL, 0x0002184002011001ULL, 0x018041000200A200ULL, 0x0000840005802000ULL,
+    0x0894080000220040ULL, 0x0004020004102402ULL, 0x0010048488012408ULL, 0x4210103108218100ULL,
+    0x0188480080441001ULL, 0x1000811422015040ULL, 0x0200400608200400ULL, 0x8481000820083280ULL,
+    0x4008048486004140ULL, 0x002100A808090510ULL, 0x1002000408220400ULL, 0x0405810888880801ULL,
+    0x100442420A300200ULL, 0x00080080B0082104ULL, 0x0000044402400300ULL, 0x0B0C040420882000ULL,
+    0x2840082040400100ULL, 0x00080800C10A0008ULL, 0x00000A08080500D4ULL, 0x0000041010014101ULL,
+    0x4A49010080844050ULL, 0x05B38205504080A1ULL, 0x0C81042006001002ULL, 0x000202104801060AULL,
+    0x000404019C88D000ULL, 0x0008180100201002ULL, 0x8890041800404102ULL, 0x2010200081044908ULL
+};
+
+const U64 rookMagicNums[64] =
+{
+    0x0100002404890942ULL, 0xA010880201101094ULL, 0x024100040008A251ULL, 0x3012000904102002ULL,
+    0x006A004008201106ULL, 0x092040100A002082ULL, 0x0020804001002011ULL, 0x0044B10480044021ULL,
+    0x1042006100840200ULL, 0x1005800200010080ULL, 0x120A00051008E200ULL, 0x0002080011010500ULL,
+    0x0412811004880080ULL, 0x0001084010200100ULL, 0x8642400221048100ULL, 0x0130400280092080ULL,
+    0x80104082450A0004ULL, 0x0002000401420088ULL, 0x941A001020040400ULL, 0x80C0080005010010ULL,
+    0x608C100008008080ULL, 0x0002004820820010ULL, 0x2180500020024000ULL, 0x0180002001D14000ULL,
+    0x4208006902000084ULL, 0xA020880204002110ULL, 0x00001020080104C0ULL, 0x0824008008080040ULL,
+    0x0010008010800804ULL, 0x0810801000802004ULL, 0x000040010100208CULL, 0x2020804000800020ULL,
+    0x0001288200041041ULL, 0x4001000100040200ULL, 0x4A02008080040002ULL, 0x0014040080080080ULL,
+    0x1830080080100082ULL, 0x0010804200201200ULL, 0x0903400280200081ULL, 0x0040400080208000ULL,
+    0x0002020001009044ULL, 0x0000440002500881ULL, 0x8082080120104004ULL, 0x0008008008040080ULL,
+    0x2010008010800800ULL, 0x0010150020010240ULL, 0x0010004000200040ULL, 0x0C61050020800040ULL,
+    0x24C1002548830002ULL, 0x3002000801040200ULL, 0x0202808004001200ULL, 0x0002000820060010ULL,
+    0x0020801000800800ULL, 0xA200802000100081ULL, 0x80A1002081004000ULL, 0x0208800090400020ULL,
+    0x0200020081004824ULL, 0x4200008200082104ULL, 0x0E00020010880441ULL, 0x11800401800A0800ULL,
+    0x0100100004200901ULL, 0x0200220040800810ULL, 0x0240044020001008ULL, 0x2280001020400080ULL
+};
+
+// Directions that a bishop and rook slide in, as {row change, column change}
+const int bishopSteps[4][2] = {{-1, -1}, {-1, 1}, {1, -1}, {1, 1}};
+const int rookSteps[4][2] = {{-1, 0}, {1, 0}, {0, -1}, {0, 1}};
+
+// Function to calculate the attacks of a slider by walking each direction until a blocker is hit
+U64 slidingAttacks (int square, U64 occupancy, const int steps[4][2])
+{
+    U64 attacks = 0;
+
+    for (int i = 0; i < 4; i++)
+    {
+        int row = square/8 + steps[i][0];
+        int col = square%8 + steps[i][1];
+
+        while (0 <= row && row <= 7 && 0 <= col && col <= 7)
+        {
+            U64 sqr = 1ULL << (63 - (row*8 + col));
+            attacks |= sqr;
+
+            // Stop after the first piece in the way
+            if (occupancy & sqr)
+                break;
+
+            row += steps[i][0];
+            col += steps[i][1];
+        }
+    }
+
+    return attacks;
+}
+
+// Function to calculate the squares that can block a slider (the last square in each direction never blocks anything)
+U64 slidingMask (int square, const int steps[4][2])
+{
+    U64 mask = 0;
+
+    for (int i = 0; i < 4; i++)
+    {
+        int row = square/8 + steps[i][0];
+        int col = square%8 + steps[i][1];
+
+        while (0 <= row + steps[i][0] && row + steps[i][0] <= 7 && 0 <= col + steps[i][1] && col + steps[i][1] <= 7)
+        {
+            mask |= 1ULL << (63 - (row*8 + col));
+            row += steps[i][0];
+            col += steps[i][1];
+        }
+    }
+
+    return mask;
+}
+
+// Function to fill the magic data and the attack table for one type of slider
+void initSlider (magic magics[64], U64 table[], const U64 magicNums[64], const int steps[4][2])
+{
+    U64 *attacks = table;
+
+    for (int square = 0; square < 64; square++)
+    {
+        magic &m = magics[square];
+        m.mask = slidingMask(square, steps);
+        m.magicNum = magicNums[square];
+        m.shift = 64 - popCount(m.mask);
+        m.attacks = attacks;
+
+        // Go through every subset of the mask (Carry-Rippler trick) and store its attacks
+        U64 occupancy = 0;
+        do
+        {
+            m.attacks[magicIndex(m, occupancy)] = slidingAttacks(square, occupancy, steps);
+            occupancy = (occupancy - m.mask) & m.mask;
+        }
+        while (occupancy);
+
+        // Move on to the next free part of the table
+        attacks += 1ULL << (64 - m.shift);
+    }
+}
+
+// Function to fill the attack tables, using pext indices when the processor supports them
+void initMagics ()
+{
+#if defined(PEXT_AVAILABLE)
+    usePext = __builtin_cpu_supports("bmi2");
+#endif
+
+    initSlider(bishopMagics, bishopTable, bishopMagicNums, bishopSteps);
+    initSlider(rookMagics, rookTable, rookMagicNums, rookSteps);
+
+    // Find the squares between and in line with every pair of squares that a slider could connect
+    for (int a = 0; a < 64; a++)
+    {
+        for (int b = 0; b < 64; b++)
+        {
+            U64 aVal = 1ULL << (63 - a), bVal = 1ULL << (63 - b);
+
+            sqrsBetween[a][b] = sqrsInLine[a][b] = 0;
+
+            if (bishopAttacks(0, a) & bVal)
+            {
+                sqrsBetween[a][b] = bishopAttacks(bVal, a) & bishopAttacks(aVal, b);
+                sqrsInLine[a][b] = (bishopAttacks(0, a) & bishopAttacks(0, b)) | aVal | bVal;
+            }
+            else if (rookAttacks(0, a) & bVal)
+            {
+                sqrsBetween[a][b] = rookAttacks(bVal, a) & rookAttacks(aVal, b);
+                sqrsInLine[a][b] = (rookAttacks(0, a) & rookAttacks(0, b)) | aVal | bVal;
+            }
+        }
+    }
+}
@@ -0,0 +1,84 @@
+/// magics.h
+///
+/// Willie Lei
+/// Header file for magics.cpp
+
+#ifndef MAGICS_H_INCLUDED
+#define MAGICS_H_INCLUDED
+
+#include "legal_moves.h"
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#define PEXT_AVAILABLE
+#endif
+
+// Struct storing everything needed to look up the attacks of a slider on one square
+struct magic
+{
+    // The squares whose occupancy can block the slider (edges are left out)
+    U64 mask;
+
+    // The number that hashes a masked occupancy to an index
+    U64 magicNum;
+
+    // Pointer to the first attack set for this square in the shared attack table
+    U64 *attacks;
+
+    // Amount to shift the product by (64 minus the number of bits in the mask)
+    int shift;
+};
+
+// Magic lookup data for every square
+extern magic bishopMagics[64];
+extern magic rookMagics[64];
+
+// The squares strictly between two squares on the same row, column or diagonal (0 if they aren't lined up)
+extern U64 sqrsBetween[64][64];
+
+// The whole row, column or diagonal going through two squares (0 if they aren't lined up)
+extern U64 sqrsInLine[64][64];
+
+// Whether the attack tables were laid out for the BMI2 pext instruction
+extern bool usePext;
+
+// Function that fills the attack tables (must be called before any move generation)
+void initMagics ();
+
+// Function to extract the bits of a 64-bit integer selected by a mask into the low bits
+inline U64 pext (U64 n, U64 mask)
+{
+#if defined(PEXT_AVAILABLE)
+    U64 result;
+    asm ("pextq %2, %1, %0" : "=r" (result) : "r" (n), "r" (mask));
+    return result;
+#else
+    (void)n;
+    (void)mask;
+    return 0;
+#endif
+}
+
+// Function to return the index of an occupancy in the attack table of a square
+inline unsigned magicIndex (const magic &m, U64 occupancy)
+{
+    if (usePext)
+        return (unsigned)pext(occupancy, m.mask);
+
+    return (unsigned)(((occupancy & m.mask) * m.magicNum) >> m.shift);
+}
+
+// Function to return the squares a bishop attacks from a square (including the first blocker in each direction)
+inline U64 bishopAttacks (U64 occupancy, int square)
+{
+    const magic &m = bishopMagics[square];
+    return m.attacks[magicIndex(m, occupancy)];
+}
+
+// Function to return the squares a rook attacks from a square (including the first blocker in each direction)
+inline U64 rookAttacks (U64 occupancy, int square)
+{
+    const magic &m = rookMagics[square];
+    return m.attacks[magicIndex(m, occupancy)];
+}
+
+#endif // MAGICS_H_INCLUDED
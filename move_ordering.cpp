@@ -0,0 +1,107 @@
+/// move_ordering.cpp
+///
+/// Willie Lei
+/// Decides the order moves are searched in, using the hash move, captures (most valuable victim,
+/// least valuable attacker), killer moves and the history heuristic.
+
+#include "move_ordering.h"
+
+using namespace std;
+
+// Function to give every move a score, so that the moves most likely to cause a cutoff are searched first
+void scoreMoves (const bitboard &bBoard, plyList &moves, int scores[], ply hashMove, const searchInfo &info, int height, bool whiteMove)
+{
+    for (int i = 0; i < moves.size; i++)
+    {
+        ply p = moves[i];
+
+        if (p == hashMove)
+        {
+            scores[i] = HASHMOVESCORE;
+        }
+        else if (isTactical(bBoard, p))
+        {
+            // Take the most valuable victim first, then use the least valuable attacker (kings last)
+            int victim = (plyType(p) == ENPASSANT) ? PAWN : getPieceOn(bBoard, plyDest(p));
+            int attacker = getPieceOn(bBoard, plyCurr(p)) % 6;
+            int victimVal = (victim >= 0) ? pieceVals[victim % 6] : 0;
+
+            // A promotion gains the piece it promotes to
+            if (plyType(p) == PROMOTION)
+                victimVal += pieceVals[plyPromotion(p)] - pieceVals[PAWN];
+
+            scores[i] = CAPTURESCORE + 8*victimVal - attacker;
+        }
+        else if (height < MAXDEPTH && p == info.killers[height][0])
+        {
+            scores[i] = KILLER1SCORE;
+        }
+        else if (height < MAXDEPTH && p == info.killers[height][1])
+        {
+            scores[i] = KILLER2SCORE;
+        }
+        else
+        {
+            scores[i] = info.history[whiteMove][plyCurr(p)][plyDest(p)];
+        }
+    }
+}
+
+// Function to move the best scoring of the moves that haven't been searched yet to position i and return it
+// (picking one at a time avoids sorting the moves that are never searched after a cutoff)
+ply pickMove (plyList &moves, int scores[], int i)
+{
+    int best = i;
+
+    for (int j = i + 1; j < moves.size; j++)
+    {
+        if (scores[j] > scores[best])
+            best = j;
+    }
+
+    swap(moves[i], moves[best]);
+    swap(scores[i], scores[best]);
+
+    return moves[i];
+}
+
+// Function to return whether a move captures a piece or promotes a pawn
+bool isTactical (const bitboard &bBoard, ply p)
+{
+    return (bBoard.pieces & sqrVal[plyDest(p)]) || plyType(p) == ENPASSANT || plyType(p) == PROMOTION;
+}
+
+// Function to remember a quiet move that caused a cutoff in the killer moves and the history table
+void updateHeuristics (searchInfo &info, ply p, int depth, int height, bool whiteMove)
+{
+    // Keep the two most recent killer moves at this distance from the root
+    if (height < MAXDEPTH && info.killers[height][0] != p)
+    {
+        info.killers[height][1] = info.killers[height][0];
+        info.killers[height][0] = p;
+    }
+
+    // Deeper cutoffs are worth more, and every score is halved if one gets too big
+    int &score = info.history[whiteMove][plyCurr(p)][plyDest(p)];
+    score += depth*depth;
+
+    if (score > MAXHISTORY)
+    {
+        for (int side = 0; side < 2; side++)
+            for (int curr = 0; curr < 64; curr++)
+                for (int dest = 0; dest < 64; dest++)
+                    info.history[side][curr][dest] /= 2;
+    }
+}
+
+// Function to clear the killer moves and shrink the history scores before a new search
+void resetHeuristics (searchInfo &info)
+{
+    for (int height = 0; height < MAXDEPTH; height++)
+        info.killers[height][0] = info.killers[height][1] = 0;
+
+    for (int side = 0; side < 2; side++)
+        for (int curr = 0; curr < 64; curr++)
+            for (int dest = 0; dest < 64; dest++)
+                info.history[side][curr][dest] /= 2;
+}
@@ -0,0 +1,33 @@
+/// move_ordering.h
+///
+/// Willie Lei
+/// Header file for move_ordering.cpp
+
+#ifndef MOVE_ORDERING_H_INCLUDED
+#define MOVE_ORDERING_H_INCLUDED
+
+#include "search.h"
+
+// Scores given to each kind of move (history scores always stay below the killer moves)
+#define HASHMOVESCORE 1000000
+#define CAPTURESCORE 200000
+#define KILLER1SCORE 150000
+#define KILLER2SCORE 140000
+#define MAXHISTORY 100000
+
+// Function to give every move a score, so that the moves most likely to cause a cutoff are searched first
+void scoreMoves (const bitboard &bBoard, plyList &moves, int scores[], ply hashMove, const searchInfo &info, int height, bool whiteMove);
+
+// Function to move the best scoring of the moves that haven't been searched yet to position i and return it
+ply pickMove (plyList &moves, int scores[], int i);
+
+// Function to return whether a move captures a piece or promotes a pawn
+bool isTactical (const bitboard &bBoard, ply p);
+
+// Function to remember a quiet move that caused a cutoff in the killer moves and the history table
+void updateHeuristics (searchInfo &info, ply p, int depth, int height, bool whiteMove);
+
+// Function to clear the killer moves and shrink the history scores before a new search
+void resetHeuristics (searchInfo &info);
+
+#endif // MOVE_ORDERING_H_INCLUDED
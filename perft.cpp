@@ -0,0 +1,158 @@
+/// perft.cpp
+///
+/// Willie Lei
+/// Perft (performance test) harness for counting the positions the move generator reaches.
+
+#include <iostream>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include "perft.h"
+
+using namespace std;
+
+// Entry in the perft hash table
+// The key is stored XORed with the data, so an entry torn by two threads writing at once fails the key check
+struct perftEntry
+{
+    atomic <U64> keyXorData;
+    atomic <U64> data;
+};
+
+// The perft hash table (empty when hashing is turned off)
+vector <perftEntry> perftTable(0);
+
+// Function to set up the perft hash table with a size in megabytes (0 turns hashing off)
+void setPerftHash (int hashMB)
+{
+    size_t numEntries = 0;
+
+    // Use the largest power of 2 that fits so the index can be taken with a mask
+    if (hashMB > 0)
+    {
+        numEntries = 1;
+        while (numEntries * 2 * sizeof(perftEntry) <= (size_t)hashMB * 1024 * 1024)
+            numEntries *= 2;
+    }
+
+    vector <perftEntry> newTable(numEntries);
+    perftTable.swap(newTable);
+    clearPerftHash();
+}
+
+// Function to empty the perft hash table
+void clearPerftHash ()
+{
+    for (unsigned int i = 0; i < perftTable.size(); i++)
+    {
+        perftTable[i].keyXorData.store(0, memory_order_relaxed);
+        perftTable[i].data.store(0, memory_order_relaxed);
+    }
+}
+
+// Function to count the positions reachable from a position in a number of plies
+U64 perft (bitboard &bBoard, int depth, bool whiteMove)
+{
+    if (depth <= 0)
+        return 1;
+
+    plyList legalMoves;
+    getLegalMoves(bBoard, whiteMove, legalMoves);
+
+    // Bulk counting - at the last ply, the number of legal moves is the number of leaf nodes
+    if (depth == 1)
+        return legalMoves.size;
+
+    // Look for the position in the hash table (the data holds the count and the depth in its low 8 bits)
+    U64 key = 0;
+    perftEntry *entry = NULL;
+
+    if (perftTable.size() > 0)
+    {
+        key = bBoard.key;
+        entry = &perftTable[key & (perftTable.size() - 1)];
+
+        U64 data = entry->data.load(memory_order_relaxed);
+        U64 keyXorData = entry->keyXorData.load(memory_order_relaxed);
+
+        if ((keyXorData ^ data) == key && (int)(data & 255) == depth)
+            return data >> 8;
+    }
+
+    // Add up the counts after every legal move
+    U64 nodes = 0;
+    for (int i = 0; i < legalMoves.size; i++)
+    {
+        undo u;
+        makeMove(bBoard, legalMoves[i], u);
+        nodes += perft(bBoard, depth-1, !whiteMove);
+        unmakeMove(bBoard, u);
+    }
+
+    // Store the count in the hash table
+    if (entry != NULL)
+    {
+        U64 data = (nodes << 8) | depth;
+        entry->keyXorData.store(key ^ data, memory_order_relaxed);
+        entry->data.store(data, memory_order_relaxed);
+    }
+
+    return nodes;
+}
+
+// Function to run perft, printing the count for each move at the root, the total and the speed
+// The root moves are split between the threads, which share the hash table
+U64 perftDivide (const bitboard &bBoard, int depth, bool whiteMove, int numThreads, int hashMB)
+{
+    auto startTime = chrono::steady_clock::now();
+
+    setPerftHash(hashMB);
+
+    // At depth 0 the position itself is the only leaf, so there are no root moves to divide
+    plyList legalMoves;
+    if (depth > 0)
+        getLegalMoves(bBoard, whiteMove, legalMoves);
+    vector <U64> counts(legalMoves.size, 0);
+    atomic <int> nextMove(0);
+
+    // Each thread keeps taking the next root move that hasn't been counted yet
+    auto worker = [&]()
+    {
+        int i;
+        while ((i = nextMove.fetch_add(1)) < legalMoves.size)
+        {
+            // Each root move is counted on its own copy of the bitboard
+            bitboard bBoard2 = bBoard;
+            undo u;
+            makeMove(bBoard2, legalMoves[i], u);
+            counts[i] = perft(bBoard2, depth-1, !whiteMove);
+        }
+    };
+
+    vector <thread> threads;
+    for (int i = 1; i < numThreads; i++)
+        threads.push_back(thread(worker));
+    worker();
+    for (unsigned int i = 0; i < threads.size(); i++)
+        threads[i].join();
+
+    // Output the divide breakdown
+    U64 total = 0;
+    for (int i = 0; i < legalMoves.size; i++)
+    {
+        cout << plyToString(legalMoves[i]) << ": " << counts[i] << endl;
+        total += counts[i];
+    }
+
+    if (depth <= 0)
+        total = 1;
+
+    double seconds = chrono::duration <double> (chrono::steady_clock::now() - startTime).count();
+
+    cout << endl << "Nodes: " << total << endl;
+    cout << "Time: " << (int)(seconds * 1000) << " ms" << endl;
+    cout << "Nodes per second: " << (U64)(total / (seconds > 0 ? seconds : 1e-9)) << endl;
+
+    return total;
+}
@@ -0,0 +1,21 @@
+/// perft.h
+///
+/// Willie Lei
+/// Header file for perft.cpp
+
+#ifndef PERFT_H_INCLUDED
+#define PERFT_H_INCLUDED
+
+#include "legal_moves.h"
+
+// Function to count the positions (leaf nodes) reachable from a position in a number of plies
+U64 perft (bitboard &bBoard, int depth, bool whiteMove);
+
+// Function to run perft, printing the count for each move at the root, the total and the speed
+U64 perftDivide (const bitboard &bBoard, int depth, bool whiteMove, int numThreads, int hashMB);
+
+// Functions to set up and clear the perft hash table
+void setPerftHash (int hashMB);
+void clearPerftHash ();
+
+#endif // PERFT_H_INCLUDED
@@ -0,0 +1,23 @@
+/// piece_square_tables.cpp
+///
+/// Willie Lei
+/// Piece-square tables used to evaluate where the pieces stand.
+
+#include "piece_square_tables.h"
+
+using namespace std;
+
+// Function to calculate the piece-square values and the phase of a position from scratch
+void calcPieceSquareVals (bitboard &bBoard)
+{
+    bBoard.mgVal = 0;
+    bBoard.egVal = 0;
+    bBoard.phase = 0;
+
+    for (int piece = 0; piece < 12; piece++)
+    {
+        U64 squares = bBoard.*pieceBoards[piece];
+        while (squares)
+            addPieceSquareVal(bBoard, piece, popSquare(squares));
+    }
+}
@@ -0,0 +1,119 @@
+/// piece_square_tables.h
+///
+/// Willie Lei
+/// Header file for piece_square_tables.cpp
+
+#ifndef PIECE_SQUARE_TABLES_H_INCLUDED
+#define PIECE_SQUARE_TABLES_H_INCLUDED
+
+#include "legal_moves.h"
+
+// How much each type of piece counts towards the phase of the game
+// The starting position has a phase of MAXPHASE (the middlegame) and a board with only pawns and kings has 0 (the endgame)
+constexpr int phaseVals[6] = {0, 1, 1, 2, 4, 0};
+#define MAXPHASE 24
+
+// Calculate the value of a piece located on a particular square (centre is better)
+constexpr int calcLocVal (int square)
+{
+    // The values are as follows:
+    //
+    // -10 -10 -10 -10 -10 -10 -10 -10
+    // -10   0   0   0   0   0   0 -10
+    // -10   0  10  10  10  10   0 -10
+    // -10   0  10  20  20  10   0 -10
+    // -10   0  10  20  20  10   0 -10
+    // -10   0  10  10  10  10   0 -10
+    // -10   0   0   0   0   0   0 -10
+    // -10 -10 -10 -10 -10 -10 -10 -10
+    //
+
+    // Determine which concentric box the square is a part of
+    if (square/8 == 0 || square/8 == 7 || square%8 == 0 || square%8 == 7)
+        return -10;
+    else if (square/8 == 1 || square/8 == 6 || square%8 == 1 || square%8 == 6)
+        return 0;
+    else if (square/8 == 2 || square/8 == 5 || square%8 == 2 || square%8 == 5)
+        return 10;
+    else
+        return 20;
+}
+
+// Function to return how much a white piece of a type is worth on a square (not counting its material value)
+// in the middlegame or in the endgame
+constexpr int calcPieceSquareVal (int type, int square, bool endgame)
+{
+    int advance = 6 - square/8;
+    int centre = calcLocVal(square);
+
+    switch (type)
+    {
+        // Pawns should control the centre early on and push on to promote later
+        case PAWN:
+            return endgame ? 10*advance : 3*advance + centre;
+        // Minor pieces are best in the centre
+        case KNIGHT:
+            return 2*centre;
+        case BISHOP:
+            return centre;
+        // Rooks and queens shouldn't come out into the middle early on, but rooks like the 7th row
+        case ROOK:
+            return (square/8 == 1 ? 20 : 0) - (endgame ? 0 : centre/2);
+        case QUEEN:
+            return endgame ? centre : -centre/2;
+        // Kings should stay on the back row behind their pawns until the endgame, when they should come to the centre
+        default:
+            return endgame ? 2*centre : -2*centre - 10*(7 - square/8);
+    }
+}
+
+// Struct holding the middlegame and endgame value of each type of piece on each square (in the same order as pieceBoards)
+// Black's values are white's flipped to the other side of the board and negated, so the sum of the values of
+// every piece is from white's point of view
+struct pieceSquareTables
+{
+    int mg[12][64];
+    int eg[12][64];
+};
+
+// Function to make the tables (at compile time)
+constexpr pieceSquareTables makePieceSquareTables ()
+{
+    pieceSquareTables tables {};
+
+    for (int type = 0; type < 6; type++)
+    {
+        for (int square = 0; square < 64; square++)
+        {
+            tables.mg[type][square] = calcPieceSquareVal(type, square, false);
+            tables.eg[type][square] = calcPieceSquareVal(type, square, true);
+            tables.mg[type+6][square ^ 56] = -tables.mg[type][square];
+            tables.eg[type+6][square ^ 56] = -tables.eg[type][square];
+        }
+    }
+
+    return tables;
+}
+
+constexpr pieceSquareTables pst = makePieceSquareTables();
+
+// Functions to add and take away the values of a piece on a square (makeMove keeps bitboard::mgVal, egVal and phase
+// up to date this way)
+inline void addPieceSquareVal (bitboard &bBoard, int piece, int square)
+{
+    bBoard.mgVal += pst.mg[piece][square];
+    bBoard.egVal += pst.eg[piece][square];
+    bBoard.phase += phaseVals[piece % 6];
+}
+
+inline void removePieceSquareVal (bitboard &bBoard, int piece, int square)
+{
+    bBoard.mgVal -= pst.mg[piece][square];
+    bBoard.egVal -= pst.eg[piece][square];
+    bBoard.phase -= phaseVals[piece % 6];
+}
+
+// Function to calculate the piece-square values and the phase of a position from scratch
+void calcPieceSquareVals (bitboard &bBoard);
+
+#endif // PIECE_SQUARE_TABLES_H_INCLUDED
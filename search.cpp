@@ -0,0 +1,603 @@
+/// search.cpp
+///
+/// Willie Lei
+/// The chess engine: iterative deepening alpha-beta search and board evaluation.
+
+#include <thread>
+#include <memory>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include "search.h"
+#include "move_ordering.h"
+#include "transposition_table.h"
+#include "split_search.h"
+#include "piece_square_tables.h"
+#include "book.h"
+
+using namespace std;
+
+// Function to make the table of how many plies to reduce a late move by, for each depth and move number
+array <array <int, MAXMOVES>, MAXDEPTH> makeReductions ()
+{
+    array <array <int, MAXMOVES>, MAXDEPTH> table {};
+
+    for (int depth = 1; depth < MAXDEPTH; depth++)
+        for (int moveNum = 1; moveNum < MAXMOVES; moveNum++)
+            table[depth][moveNum] = (int)(LMRBASE + log(depth) * log(moveNum) / LMRDIVISOR);
+
+    return table;
+}
+
+const array <array <int, MAXMOVES>, MAXDEPTH> reductions = makeReductions();
+
+// Function to find the best move for the computer, searching one ply deeper at a time until the limits are reached
+// The best move of the last completed iteration is returned, so the search can be stopped at any time
+// With more than one thread, helper threads search the same position on their own copy of the bitboard (Lazy SMP)
+// and fill the shared transposition table, which the main thread then uses to search deeper sooner
+// With split points turned on, the threads instead share the moves of each node, which gives the same result and
+// node count with any number of threads (see split_search.cpp)
+ply findBestMove (bitboard &bBoard, bool compIsWhite, searchInfo &info)
+{
+    // Set up the search
+    info.nodes = 0;
+    info.completedDepth = 0;
+    info.score = 0;
+    info.bestMove = 0;
+    info.stop = false;
+    info.startTime = chrono::steady_clock::now();
+    info.deadline = info.startTime + chrono::milliseconds(info.limits.moveTime);
+
+    // Play straight from the opening book if the position is in it
+    info.bestMove = probeBook(bBoard, compIsWhite);
+    if (info.bestMove != 0)
+    {
+        info.stop = true;
+        return info.bestMove;
+    }
+
+    newSearchTT(*info.tt);
+    resetHeuristics(info);
+
+    // Start the helper threads
+    vector <unique_ptr <searchInfo>> helpers;
+    vector <thread> threads;
+    if (info.limits.splitPoints)
+        startSplitThreads(info.limits.threads - 1, info);
+
+    for (int i = 1; i < info.limits.threads && !info.limits.splitPoints; i++)
+    {
+        helpers.push_back(unique_ptr <searchInfo> (new searchInfo));
+        helpers.back()->limits = info.limits;
+        helpers.back()->tt = info.tt;
+        helpers.back()->mainInfo = &info;
+        helpers.back()->threadNum = i;
+        threads.push_back(thread(iterativeDeepening, bBoard, compIsWhite, ref(*helpers.back())));
+    }
+
+    // Search on this thread, then stop the helpers
+    iterativeDeepening(bBoard, compIsWhite, info);
+    info.stop = true;
+    for (unsigned int i = 0; i < threads.size(); i++)
+        threads[i].join();
+    if (info.limits.splitPoints)
+        stopSplitThreads(info);
+
+    // Use the move from whichever thread finished the deepest iteration
+    for (unsigned int i = 0; i < helpers.size(); i++)
+    {
+        info.nodes += helpers[i]->nodes;
+
+        if (helpers[i]->completedDepth > info.completedDepth)
+        {
+            info.completedDepth = helpers[i]->completedDepth;
+            info.score = helpers[i]->score;
+            info.bestMove = helpers[i]->bestMove;
+        }
+    }
+
+    //cout << "Computer value is: " << info.score << endl;
+    return info.bestMove;
+}
+
+// Function that runs the iterative deepening search on one thread, storing the best move and its score in info
+// Helper threads start at different depths and with the moves in a different order, so they search different
+// parts of the tree from the main thread
+void iterativeDeepening (bitboard bBoard, bool whiteMove, searchInfo &info)
+{
+    // Get all the moves available at the root
+    plyList legalMoves;
+    getLegalMoves(bBoard, whiteMove, legalMoves);
+    int maxDepth = (info.limits.depth > 0) ? min(info.limits.depth, MAXDEPTH) : MAXDEPTH;
+
+    if (legalMoves.size > 0)
+        rotate(legalMoves.plies, legalMoves.plies + info.threadNum % legalMoves.size, legalMoves.plies + legalMoves.size);
+    info.bestMove = legalMoves.size > 0 ? legalMoves[0] : 0;
+
+    // With only one move there is nothing to choose, but search it one ply deep so it still has a score
+    if (legalMoves.size == 0)
+        return;
+    if (legalMoves.size == 1)
+        maxDepth = 1;
+
+    // Search one ply deeper each iteration
+    for (int depth = 1 + info.threadNum % 2; depth <= maxDepth; depth++)
+    {
+        int bestVal;
+        ply iterBestMove;
+
+        // Search the best move of the previous iteration first
+        moveToFront(legalMoves, info.bestMove);
+
+        // Once there is a score from an earlier iteration, expect the score to be close to it (an aspiration window)
+        int delta = ASPIRATIONWINDOW;
+        int alpha = -INFVAL, beta = INFVAL;
+        if (depth >= ASPIRATIONDEPTH && abs(info.score) < MINMATESCORE)
+        {
+            alpha = info.score - delta;
+            beta = info.score + delta;
+        }
+
+        while (true)
+        {
+            bestVal = searchRoot(bBoard, legalMoves, depth, alpha, beta, whiteMove, iterBestMove, info);
+
+            if (info.stop || bestVal >= MATESCORE - 1 || (alpha < bestVal && bestVal < beta))
+                break;
+
+            // If the score is outside the window, search again with the window widened on that side
+            // (by more each time, until the window is as wide as it can be)
+            delta *= 4;
+            if (bestVal <= alpha)
+                alpha = (delta < MAXASPIRATIONWINDOW) ? bestVal - delta : -INFVAL;
+            else
+            {
+                beta = (delta < MAXASPIRATIONWINDOW) ? bestVal + delta : INFVAL;
+                moveToFront(legalMoves, iterBestMove);
+            }
+        }
+
+        // Throw away the unfinished iteration if the search was stopped
+        if (info.stop)
+            break;
+
+        // The score is inside the window, so it is exact
+        info.bestMove = iterBestMove;
+        info.completedDepth = depth;
+        info.score = bestVal;
+
+        if (info.onIteration != NULL && info.mainInfo == NULL)
+            info.onIteration(bBoard, whiteMove, info);
+
+        // There is no need to search any deeper after finding checkmate in one
+        if (bestVal >= MATESCORE - 1)
+            return;
+
+        storeTT(*info.tt, bBoard.key, iterBestMove, bestVal, depth, EXACTBOUND, 0);
+
+        // Don't start another iteration if the limits have been reached
+        if (checkStop(info))
+            break;
+    }
+}
+
+// Function to search all the moves at the root with a window, returning the best value and storing the best move
+// Once the first move has been searched, alpha carries over to the moves after it
+// A move that gives checkmate stops the search of the rest, since nothing can be better
+int searchRoot (bitboard &bBoard, plyList &legalMoves, int depth, int alpha, int beta, bool whiteMove, ply &bestMove,
+                searchInfo &info)
+{
+    bool inCheck = getCheckers(bBoard, whiteMove) != 0;
+    int bestVal = -INFVAL;
+    bestMove = 0;
+
+    // Go through all the legal moves
+    for (int i = 0; i < legalMoves.size; i++)
+    {
+        // Once the first move has been searched, share the rest with the other threads
+        if (i > 0 && legalMoves.size - i >= 2 && canSplit(depth, info))
+        {
+            searchSplit(bBoard, legalMoves, i, depth, alpha, beta, whiteMove, 0, inCheck, false, false, bestVal, bestMove,
+                        info);
+            break;
+        }
+
+        // Evaluate the position after the move (root moves are never pruned)
+        int boardVal = searchMove(bBoard, legalMoves[i], i, depth, alpha, beta, whiteMove, 0, inCheck, false, false, info);
+
+        if (info.stop)
+            break;
+
+        // Update the best move and the best value
+        if (boardVal > bestVal)
+        {
+            bestVal = boardVal;
+            bestMove = legalMoves[i];
+        }
+        if (bestVal > alpha)
+            alpha = bestVal;
+        if (beta <= alpha || bestVal >= MATESCORE - 1)
+            break;
+    }
+
+    return bestVal;
+}
+
+// Function that uses the recursive alpha-beta algorithm (in negamax form) to return the value of a bitboard
+// The value is from the point of view of the side to move
+// A null move isn't allowed straight after another one, or while checking a null move that failed high
+int alphabeta (bitboard &bBoard, int depth, int alpha, int beta, bool whiteMove, int height, searchInfo &info,
+               bool allowNull)
+{
+    // Give up if the search has been stopped (the result is thrown away)
+    info.nodes++;
+    if ((info.nodes & 1023) == 0)
+        checkStop(info);
+    if (isStopped(info))
+        return 0;
+
+    int alphaOrig = alpha;
+    ply hashMove = 0;
+    ttData entry;
+
+    // Look for the position in the transposition table
+    if (probeTT(*info.tt, bBoard.key, entry, height, getTaskTT(info)))
+    {
+        hashMove = entry.move;
+
+        // Use the stored score if it was searched at least as deeply and is outside the window (or exact)
+        if (entry.depth >= depth)
+        {
+            if (entry.bound == EXACTBOUND)
+                return entry.score;
+            if (entry.bound == LOWERBOUND && entry.score >= beta)
+                return entry.score;
+            if (entry.bound == UPPERBOUND && entry.score <= alpha)
+                return entry.score;
+        }
+    }
+
+    // Only search captures and promotions once the search has reached the maximum depth
+    if (depth <= 0)
+        return quiescence(bBoard, alpha, beta, whiteMove, height, info);
+
+    // The pieces giving check are found once, for the pruning, the extension and the move generation
+    int materialVal = whiteMove ? bBoard.wMaterialVal - bBoard.bMaterialVal : bBoard.bMaterialVal - bBoard.wMaterialVal;
+    U64 checkers = getCheckers(bBoard, whiteMove);
+    bool inCheck = checkers != 0;
+    bool notMate = alpha > -MINMATESCORE && beta < MINMATESCORE;
+
+    // Reverse futility pruning - if the side to move is so far ahead that it would stay above beta
+    // even after losing a lot of material, don't bother searching
+    if (!inCheck && notMate && depth <= RFPDEPTH && materialVal - FUTILITYMARGIN*depth >= beta)
+        return materialVal;
+
+    // Razoring - if the side to move is far behind, check with a search of only the captures
+    // whether it can win back enough material, and give up on the position if it can't
+    if (!inCheck && notMate && depth <= RAZORDEPTH && materialVal + RAZORMARGIN*depth <= alpha)
+    {
+        int razorVal = quiescence(bBoard, alpha, beta, whiteMove, height, info);
+        if (depth == 1 || razorVal <= alpha)
+            return razorVal;
+    }
+
+    // Futility pruning - if the side to move is far enough behind that a quiet move can't bring it back to alpha,
+    // only search the moves that capture, promote or give check
+    bool futile = !inCheck && notMate && depth <= FUTILITYDEPTH && materialVal + FUTILITYMARGIN*depth <= alpha;
+
+    // Null-move pruning - if the side to move could pass and the opponent still couldn't get the score below beta,
+    // then a real move would almost certainly fail high as well, so the position is searched less deeply instead
+    // Passing isn't legal in check, and it is skipped when the side to move only has pawns (where it is often in
+    // zugzwang and every move makes its position worse)
+    int pieceMaterial = whiteMove ? bBoard.wMaterialVal - pieceVals[PAWN] * popCount(bBoard.wPawns)
+                                  : bBoard.bMaterialVal - pieceVals[PAWN] * popCount(bBoard.bPawns);
+
+    if (allowNull && !inCheck && depth >= NULLMINDEPTH && pieceMaterial > 0 && materialVal >= beta && beta < MINMATESCORE)
+    {
+        int r = (depth >= 6) ? 3 : 2;
+
+        undo u;
+        makeNullMove(bBoard, u);
+        int nullVal = -alphabeta(bBoard, depth-1-r, -beta, -beta+1, !whiteMove, height+1, info, false);
+        unmakeNullMove(bBoard, u);
+
+        if (isStopped(info))
+            return 0;
+
+        // With few pieces left, make sure with a normal search of the same depth that isn't allowed to pass
+        if (nullVal >= beta && pieceMaterial <= NULLVERIFYMATERIAL)
+            nullVal = alphabeta(bBoard, depth-r, beta-1, beta, whiteMove, height, info, false);
+
+        if (isStopped(info))
+            return 0;
+
+        // Don't trust a checkmate found by passing
+        if (nullVal >= beta)
+            return nullVal < MINMATESCORE ? nullVal : beta;
+    }
+
+    // Get all the legal moves for whoever is supposed to move
+    // (the list lives on the stack, so no memory is allocated at any node)
+    plyList legalMoves;
+    generateMoves(bBoard, whiteMove, legalMoves, false, checkers);
+
+    // With no legal moves, the side to move has been checkmated or it is stalemate
+    if (legalMoves.size == 0)
+        return inCheck ? -(MATESCORE - height) : 0;
+
+    // Score the moves so the ones most likely to cause a cutoff are searched first
+    int scores[MAXMOVES];
+    scoreMoves(bBoard, legalMoves, scores, hashMove, info, height, whiteMove);
+
+    int bestVal = -INFVAL;
+    ply bestMove = 0;
+
+    // Go through all the legal moves, searching for the move that is best for the side to move
+    for (int i = 0; i < legalMoves.size; i++)
+    {
+        // Once the first move has been searched, there is a bound to search the rest with,
+        // so they can be shared with the other threads (Young Brothers Wait)
+        if (i > 0 && legalMoves.size - i >= 2 && canSplit(depth, info))
+        {
+            for (int j = i; j < legalMoves.size; j++)
+                pickMove(legalMoves, scores, j);
+
+            searchSplit(bBoard, legalMoves, i, depth, alpha, beta, whiteMove, height, inCheck, bestVal > -MINMATESCORE,
+                        futile, bestVal, bestMove, info);
+            if (isStopped(info))
+                return 0;
+            break;
+        }
+
+        // Search the next best move (late quiet moves can be pruned once a move that doesn't get mated was found)
+        ply move = pickMove(legalMoves, scores, i);
+        int boardVal = searchMove(bBoard, move, i, depth, alpha, beta, whiteMove, height, inCheck, bestVal > -MINMATESCORE,
+                                  futile, info);
+
+        if (isStopped(info))
+            return 0;
+
+        // Update the best board value and alpha, the best position the side to move is guaranteed of
+        if (boardVal > bestVal)
+        {
+            bestVal = boardVal;
+            bestMove = move;
+        }
+        if (bestVal > alpha)
+            alpha = bestVal;
+
+        // Stop if the opponent would never allow this position, remembering the move if it was quiet
+        if (beta <= alpha)
+        {
+            if (!isTactical(bBoard, move))
+                updateHeuristics(info, move, depth, height, whiteMove);
+            break;
+        }
+    }
+
+    // Store the result, recording whether it is only a bound
+    if (bestVal <= alphaOrig)
+        storeTT(*info.tt, bBoard.key, bestMove, bestVal, depth, UPPERBOUND, height, getTaskTT(info));
+    else if (bestVal >= beta)
+        storeTT(*info.tt, bBoard.key, bestMove, bestVal, depth, LOWERBOUND, height, getTaskTT(info));
+    else
+        storeTT(*info.tt, bBoard.key, bestMove, bestVal, depth, EXACTBOUND, height, getTaskTT(info));
+
+    return bestVal;
+}
+
+// Function that makes a move, searches it with the alpha-beta algorithm and takes it back, returning its value
+// Only the first move at a node is searched with the whole window (principal variation search) - later moves
+// are expected to be worse, so they are searched with a null window just above alpha to prove it, and only
+// searched again with the whole window if they turn out to be better
+// A late quiet move (one that doesn't give check, made when not in check) is searched less deeply, and only
+// searched again at full depth if it raises alpha. Near the leaves, or at any quiet move if futile is set,
+// it isn't searched at all if canPrune is set, in which case -INFVAL is returned
+int searchMove (bitboard &bBoard, ply move, int moveNum, int depth, int alpha, int beta, bool whiteMove, int height,
+                bool inCheck, bool canPrune, bool futile, searchInfo &info)
+{
+    bool quiet = !inCheck && !isTactical(bBoard, move);
+
+    undo u;
+    makeMove(bBoard, move, u);
+
+    if (quiet && isInCheck(bBoard, whiteMove ? getBKingLoc(bBoard) : getWKingLoc(bBoard)))
+        quiet = false;
+
+    // Move-count and futility pruning
+    if (quiet && canPrune && (futile || (depth <= LMPDEPTH && moveNum >= LMPBASE + depth*depth)))
+    {
+        unmakeMove(bBoard, u);
+        return -INFVAL;
+    }
+
+    // Late move reductions (always leaving at least one ply to search)
+    int r = 0;
+    if (quiet && depth >= LMRMINDEPTH && moveNum >= LMRMINMOVE)
+        r = min(reductions[min(depth, MAXDEPTH-1)][min(moveNum, MAXMOVES-1)], depth-2);
+
+    int boardVal;
+
+    if (moveNum == 0)
+        boardVal = -alphabeta(bBoard, depth-1, -beta, -alpha, !whiteMove, height+1, info);
+    else
+    {
+        boardVal = -alphabeta(bBoard, depth-1-r, -alpha-1, -alpha, !whiteMove, height+1, info);
+
+        if (r > 0 && boardVal > alpha && !isStopped(info))
+            boardVal = -alphabeta(bBoard, depth-1, -alpha-1, -alpha, !whiteMove, height+1, info);
+        if (boardVal > alpha && boardVal < beta && !isStopped(info))
+            boardVal = -alphabeta(bBoard, depth-1, -beta, -alpha, !whiteMove, height+1, info);
+    }
+
+    unmakeMove(bBoard, u);
+    return boardVal;
+}
+
+// Function that searches only captures and promotions at the end of the main search, so that positions are
+// only evaluated once they are quiet (a side in check has to search all its moves, since it can't stand pat)
+int quiescence (bitboard &bBoard, int alpha, int beta, bool whiteMove, int height, searchInfo &info)
+{
+    // Give up if the search has been stopped (the result is thrown away)
+    info.nodes++;
+    if ((info.nodes & 1023) == 0)
+        checkStop(info);
+    if (isStopped(info))
+        return 0;
+
+    U64 checkers = getCheckers(bBoard, whiteMove);
+    bool inCheck = checkers != 0;
+    int bestVal = -INFVAL;
+    plyList moves;
+
+    if (inCheck)
+    {
+        generateMoves(bBoard, whiteMove, moves, false, checkers);
+
+        // Checkmate
+        if (moves.size == 0)
+            return -(MATESCORE - height);
+    }
+    else
+    {
+        // The side to move can stand pat (not capture anything), so the evaluation is a lower bound
+        bestVal = calcBoardVal(bBoard, whiteMove);
+        if (bestVal >= beta)
+            return bestVal;
+        if (bestVal > alpha)
+            alpha = bestVal;
+
+        generateMoves(bBoard, whiteMove, moves, true, 0);
+    }
+
+    // Search the biggest captures first
+    int scores[MAXMOVES];
+    scoreMoves(bBoard, moves, scores, 0, info, height, whiteMove);
+
+    U64 enemyPieces = whiteMove ? bBoard.bPieces : bBoard.wPieces;
+
+    for (int i = 0; i < moves.size; i++)
+    {
+        ply move = pickMove(moves, scores, i);
+
+        // Skip captures that can't raise alpha even if the piece is won for free (delta pruning),
+        // and captures of a cheaper piece on a defended square, which probably lose material
+        if (!inCheck && plyType(move) == NORMAL)
+        {
+            int victimVal = pieceVals[getPieceOn(bBoard, plyDest(move)) % 6];
+            int attackerVal = pieceVals[getPieceOn(bBoard, plyCurr(move)) % 6];
+
+            if (bestVal + victimVal + DELTAMARGIN <= alpha)
+                continue;
+            if (attackerVal > victimVal && (attackersTo(bBoard, plyDest(move), bBoard.pieces) & enemyPieces))
+                continue;
+        }
+
+        undo u;
+        makeMove(bBoard, move, u);
+        int boardVal = -quiescence(bBoard, -beta, -alpha, !whiteMove, height+1, info);
+        unmakeMove(bBoard, u);
+
+        if (isStopped(info))
+            return 0;
+
+        if (boardVal > bestVal)
+            bestVal = boardVal;
+        if (bestVal > alpha)
+            alpha = bestVal;
+        if (beta <= alpha)
+            break;
+    }
+
+    return bestVal;
+}
+
+// Function to check whether the search has gone past its node or time limits, setting the stop flag if it has
+bool checkStop (searchInfo &info)
+{
+    // Helper threads only stop when the main thread does
+    if (info.mainInfo != NULL)
+    {
+        if (info.mainInfo->stop.load(memory_order_relaxed))
+            info.stop = true;
+        return info.stop;
+    }
+
+    // While the main thread searches a task of a split point, it only counts the positions of the task
+    if (info.limits.nodes > 0 && info.task == NULL && info.nodes >= info.limits.nodes)
+        info.stop = true;
+    if (info.limits.moveTime > 0 && chrono::steady_clock::now() >= info.deadline)
+        info.stop = true;
+
+    return info.stop;
+}
+
+// Function to return the number of moves until checkmate for a score (negative if the side to move is the one
+// getting mated), or 0 if the score isn't a mate score
+int mateMoves (int score)
+{
+    if (score >= MINMATESCORE)
+        return (MATESCORE - score + 1) / 2;
+    if (score <= -MINMATESCORE)
+        return -(MATESCORE + score) / 2;
+
+    return 0;
+}
+
+// Function to find the principal variation (the moves both sides are expected to play) after a move,
+// by following the best moves stored in the transposition table
+void getPV (bitboard bBoard, bool whiteMove, ply firstMove, int maxLength, plyList &pv, transpositionTable &table)
+{
+    pv.size = 0;
+    ply move = firstMove;
+
+    while (move != 0 && pv.size < maxLength)
+    {
+        // Make sure the stored move is legal here (a different position could have stored it)
+        plyList legalMoves;
+        getLegalMoves(bBoard, whiteMove, legalMoves);
+        if (find(legalMoves.plies, legalMoves.plies + legalMoves.size, move) == legalMoves.plies + legalMoves.size)
+            break;
+
+        pv.add(move);
+        undo u;
+        makeMove(bBoard, move, u);
+        whiteMove = !whiteMove;
+
+        ttData entry;
+        move = probeTT(table, bBoard.key, entry, pv.size) ? entry.move : 0;
+    }
+}
+
+// Function to move a ply to the front of a list of plies (if it is in the list)
+void moveToFront (plyList &moves, ply p)
+{
+    if (p == 0)
+        return;
+
+    for (int i = 0; i < moves.size; i++)
+    {
+        if (moves[i] == p)
+        {
+            for (int j = i; j > 0; j--)
+                moves[j] = moves[j-1];
+            moves[0] = p;
+            return;
+        }
+    }
+}
+
+// Function to return the value of a board for a side
+// Checkmate and stalemate are found by the search from the number of legal moves, so they aren't looked for here
+int calcBoardVal (const bitboard &bBoard, bool forWhite)
+{
+    // Blend the middlegame and endgame piece-square values by the phase of the game
+    int phase = min(bBoard.phase, MAXPHASE);
+    int positionVal = (bBoard.mgVal * phase + bBoard.egVal * (MAXPHASE - phase)) / MAXPHASE;
+
+    // Return the board value and add material value
+    if (forWhite)
+        return (bBoard.wMaterialVal-bBoard.bMaterialVal) + positionVal;
+    else
+        return (bBoard.bMaterialVal-bBoard.wMaterialVal) - positionVal;
+}
@@ -0,0 +1,136 @@
+/// search.h
+///
+/// Willie Lei
+/// Header file for search.cpp
+
+#ifndef SEARCH_H_INCLUDED
+#define SEARCH_H_INCLUDED
+
+#include <atomic>
+#include <chrono>
+#include "legal_moves.h"
+#include "transposition_table.h"
+
+#define INFVAL 2000000000
+#define MAXDEPTH 64
+
+// How much the positional part of the evaluation can change after a capture (for delta pruning)
+#define DELTAMARGIN 200
+
+// Checkmate n plies from the root scores MATESCORE - n, so shorter mates are preferred,
+// and scores of at least MINMATESCORE (or at most -MINMATESCORE) mean checkmate
+#define MATESCORE 1000000
+#define MINMATESCORE (MATESCORE - 1000)
+
+// From ASPIRATIONDEPTH on, the root is first searched with a window ASPIRATIONWINDOW either side of the score
+// of the last iteration, widened 4 times on the side the score falls outside of until it reaches MAXASPIRATIONWINDOW
+#define ASPIRATIONDEPTH 4
+#define ASPIRATIONWINDOW 50
+#define MAXASPIRATIONWINDOW 3200
+
+// The shallowest depth to try a null move at, and the most piece (not pawn) material the side to move can have
+// for a null move that fails high to be checked by a normal search, since passing could be its best option
+#define NULLMINDEPTH 2
+#define NULLVERIFYMATERIAL 1000
+
+// Late move reductions - quiet moves from the LMRMINMOVE'th on, at least LMRMINDEPTH plies from the leaves,
+// are reduced by LMRBASE + ln(depth) * ln(move number) / LMRDIVISOR plies
+#define LMRMINDEPTH 3
+#define LMRMINMOVE 3
+#define LMRBASE 0.75
+#define LMRDIVISOR 2.25
+
+// Move-count pruning - up to LMPDEPTH plies from the leaves, quiet moves after the first
+// LMPBASE + depth * depth moves aren't searched at all
+#define LMPDEPTH 3
+#define LMPBASE 3
+
+// Pruning near the leaves using the material balance - a node is given up on when the balance is more than
+// FUTILITYMARGIN per ply left above beta (reverse futility, up to RFPDEPTH plies from the leaves), or when it
+// is that far below alpha, quiet moves aren't searched (futility, up to FUTILITYDEPTH plies), and when it is
+// more than RAZORMARGIN per ply below alpha, only captures are searched (razoring, up to RAZORDEPTH plies)
+#define FUTILITYMARGIN 200
+#define FUTILITYDEPTH 2
+#define RFPDEPTH 3
+#define RAZORMARGIN 300
+#define RAZORDEPTH 2
+
+// Limits on how long a search can go on for (0 means there is no limit)
+struct searchLimits
+{
+    int depth = 0;
+    U64 nodes = 0;
+    int moveTime = 0;   // In milliseconds
+
+    // Number of threads to search with, and whether they share the moves at split points
+    // (Young Brothers Wait) instead of each searching the whole tree (Lazy SMP)
+    int threads = 1;
+    bool splitPoints = false;
+};
+
+struct splitPool;
+struct splitTask;
+struct searchInfo;
+
+// Function called by the main search thread after every completed iteration (e.g. to report the progress)
+typedef void (*iterationCallback) (const bitboard &bBoard, bool whiteMove, const searchInfo &info);
+
+// Everything the search keeps track of while it runs
+struct searchInfo
+{
+    searchLimits limits;
+    chrono::steady_clock::time_point startTime;
+    chrono::steady_clock::time_point deadline;
+    iterationCallback onIteration = NULL;
+
+    // The transposition table the search uses (a search given a table of its own doesn't share results
+    // with any other search)
+    transpositionTable *tt = &ttTable;
+
+    // Number of positions searched so far
+    U64 nodes = 0;
+
+    // Set to stop the search (by the search itself or by another thread), after which
+    // the best move of the last completed iteration is returned
+    atomic <bool> stop {false};
+
+    // The deepest iteration that was finished, its score and its best move
+    int completedDepth = 0;
+    int score = 0;
+    ply bestMove = 0;
+
+    // For helper threads, the search of the main thread (which decides when to stop) and the number of the thread
+    searchInfo *mainInfo = NULL;
+    int threadNum = 0;
+
+    // The threads that share the moves at split points (if the search uses them), and the task of a split point
+    // the thread is searching (if any)
+    splitPool *pool = NULL;
+    splitTask *task = NULL;
+
+    // Two quiet moves for each distance from the root that caused a cutoff (killer moves),
+    // and a score for every quiet move by side, current square and destination square (history)
+    ply killers[MAXDEPTH][2] = {};
+    int history[2][64][64] = {};
+};
+
+// Search functions
+ply findBestMove (bitboard &bBoard, bool compIsWhite, searchInfo &info);
+void iterativeDeepening (bitboard bBoard, bool whiteMove, searchInfo &info);
+int searchRoot (bitboard &bBoard, plyList &legalMoves, int depth, int alpha, int beta, bool whiteMove, ply &bestMove,
+                searchInfo &info);
+int alphabeta (bitboard &bBoard, int depth, int alpha, int beta, bool whiteMove, int height, searchInfo &info,
+               bool allowNull = true);
+int searchMove (bitboard &bBoard, ply move, int moveNum, int depth, int alpha, int beta, bool whiteMove, int height,
+                bool inCheck, bool canPrune, bool futile, searchInfo &info);
+int quiescence (bitboard &bBoard, int alpha, int beta, bool whiteMove, int height, searchInfo &info);
+bool checkStop (searchInfo &info);
+int mateMoves (int score);
+void getPV (bitboard bBoard, bool whiteMove, ply firstMove, int maxLength, plyList &pv,
+           transpositionTable &table = ttTable);
+void moveToFront (plyList &moves, ply p);
+
+// Evaluation functions
+int calcBoardVal (const bitboard &bBoard, bool forWhite);
+
+#endif // SEARCH_H_INCLUDED
@@ -0,0 +1,338 @@
+/// selfplay.cpp
+///
+/// Willie Lei
+/// Self-play matches between two engines with different search limits, for testing changes to the engine.
+///
+/// Games are played on several threads at once, each with a search and a transposition table of its own for both
+/// sides. The tables and move histories are emptied before every game, so neither engine can use the other's
+/// results, and no game depends on the games played before it. Games are ended early when the result is clear,
+/// and the match itself ends once the SPRT has decided which engine is better.
+
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <algorithm>
+#include <sstream>
+#include <cmath>
+#include <cstdlib>
+#include "selfplay.h"
+#include "fen.h"
+
+using namespace std;
+
+// A starting position for games
+struct opening
+{
+    bitboard bBoard;
+    bool whiteMove;
+    int halfMoves;
+};
+
+// Everything the threads of a match share
+struct selfPlayMatch
+{
+    vector <opening> openings;
+    int numGames;
+    searchLimits limits[2];
+    int hashMB;
+    atomic <int> nextGame;
+    atomic <bool> finished;
+    matchResult result;
+    mutex lock;
+    ostream *out;
+};
+
+// Function to check whether neither side has enough pieces left to checkmate
+bool isInsufficientMaterial (const bitboard &bBoard)
+{
+    if (bBoard.wPawns | bBoard.bPawns | bBoard.wRooks | bBoard.bRooks | bBoard.wQueens | bBoard.bQueens)
+        return false;
+
+    return popCount(bBoard.wKnights | bBoard.wBishops | bBoard.bKnights | bBoard.bBishops) <= 1;
+}
+
+// Function to play one game from an opening, returning the result and storing why the game ended
+// engines[1] plays white and engines[0] plays black, and halfMoves is the fifty moves rule count of the opening
+int playSelfPlayGame (bitboard bBoard, bool whiteMove, int halfMoves, searchInfo *engines[2], string &reason)
+{
+    // Keys of the positions since the last capture or pawn move (the only ones that can be repeated)
+    vector <U64> keys;
+    int wAheadPlies = 0, bAheadPlies = 0, drawnPlies = 0;
+
+    // Start both engines from nothing
+    for (int i = 0; i < 2; i++)
+    {
+        clearTT(*engines[i]->tt);
+        fill(&engines[i]->history[0][0][0], &engines[i]->history[0][0][0] + 2*64*64, 0);
+    }
+
+    for (int plyNum = 0; ; plyNum++)
+    {
+        // Check whether the game is over by the rules
+        int result = getGameResult(bBoard, whiteMove);
+        if (result != NORESULT)
+        {
+            reason = (result == DRAW) ? "Stalemate" : (result == WHITEWINS) ? "White mates" : "Black mates";
+            return result;
+        }
+        if (halfMoves >= 100)
+        {
+            reason = "Draw by fifty moves rule";
+            return DRAW;
+        }
+        if (count(keys.begin(), keys.end(), bBoard.key) >= 2)
+        {
+            reason = "Draw by 3-fold repetition";
+            return DRAW;
+        }
+        if (isInsufficientMaterial(bBoard))
+        {
+            reason = "Draw by insufficient mating material";
+            return DRAW;
+        }
+
+        // Adjudicate games that have gone on too long or where one side is far ahead
+        if (plyNum >= MAXGAMEPLIES)
+        {
+            reason = "Draw by adjudication: game length";
+            return DRAW;
+        }
+
+        wAheadPlies = (bBoard.wMaterialVal - bBoard.bMaterialVal >= ADJUDICATEMATERIAL) ? wAheadPlies + 1 : 0;
+        bAheadPlies = (bBoard.bMaterialVal - bBoard.wMaterialVal >= ADJUDICATEMATERIAL) ? bAheadPlies + 1 : 0;
+        if (wAheadPlies >= ADJUDICATEPLIES || bAheadPlies >= ADJUDICATEPLIES)
+        {
+            reason = "Win by adjudication: material";
+            return (wAheadPlies >= ADJUDICATEPLIES) ? WHITEWINS : BLACKWINS;
+        }
+
+        // Let the engine whose turn it is pick a move, and adjudicate a draw if both keep scoring the game as level
+        searchInfo &engine = *engines[whiteMove];
+        ply move = findBestMove(bBoard, whiteMove, engine);
+
+        // (a search that didn't finish an iteration has no score, so it doesn't count either way)
+        if (engine.completedDepth > 0)
+            drawnPlies = (plyNum >= DRAWADJUDICATEPLY && abs(engine.score) <= DRAWADJUDICATESCORE) ? drawnPlies + 1 : 0;
+        if (drawnPlies >= DRAWADJUDICATEPLIES)
+        {
+            reason = "Draw by adjudication: score";
+            return DRAW;
+        }
+
+        // Make the move, starting the fifty moves rule and the repetitions over after a capture or pawn move
+        undo u;
+        keys.push_back(bBoard.key);
+        makeMove(bBoard, move, u);
+        whiteMove = !whiteMove;
+
+        if (u.capturedPiece >= 0 || u.movedPiece % 6 == PAWN)
+        {
+            halfMoves = 0;
+            keys.clear();
+        }
+        else
+            halfMoves++;
+    }
+}
+
+// Function to work out the Elo difference of a match (engine A minus engine B), along with the margin of error
+// that it is within 95% of the time
+double getElo (const matchResult &result, double &errorMargin)
+{
+    int numGames = result.wins + result.draws + result.losses;
+    if (numGames == 0)
+    {
+        errorMargin = 0;
+        return 0;
+    }
+
+    // The mean score per game and its variance
+    double score = (result.wins + 0.5 * result.draws) / numGames;
+    double variance = (result.wins * (1 - score) * (1 - score) + result.draws * (0.5 - score) * (0.5 - score)
+                       + result.losses * score * score) / numGames;
+    double scoreMargin = 1.96 * sqrt(variance / numGames);
+
+    auto scoreToElo = [] (double s)
+    {
+        s = min(max(s, 1e-6), 1 - 1e-6);
+        return -400 * log10(1 / s - 1);
+    };
+
+    errorMargin = (scoreToElo(score + scoreMargin) - scoreToElo(score - scoreMargin)) / 2;
+    return scoreToElo(score);
+}
+
+// Function to work out the log-likelihood ratio of H1 (engine A is SPRTELO1 stronger) against H0 (engine A is
+// SPRTELO0 stronger), treating the score of each game as normally distributed
+double getLLR (const matchResult &result)
+{
+    int numGames = result.wins + result.draws + result.losses;
+    if (numGames == 0)
+        return 0;
+
+    double score = (result.wins + 0.5 * result.draws) / numGames;
+    double variance = (result.wins * (1 - score) * (1 - score) + result.draws * (0.5 - score) * (0.5 - score)
+                       + result.losses * score * score) / numGames;
+    if (variance <= 0)
+        return 0;
+
+    double score0 = 1 / (1 + pow(10, -SPRTELO0 / 400));
+    double score1 = 1 / (1 + pow(10, -SPRTELO1 / 400));
+
+    return numGames * (score1 - score0) * (2 * score - score0 - score1) / (2 * variance);
+}
+
+// Function to write the score of a match so far, and stop the match if the SPRT has finished
+void reportScore (selfPlayMatch &match)
+{
+    const matchResult &r = match.result;
+    int numGames = r.wins + r.draws + r.losses;
+    double errorMargin;
+    double elo = getElo(r, errorMargin);
+    double llr = getLLR(r);
+    double lowerBound = log(SPRTBETA / (1 - SPRTALPHA));
+    double upperBound = log((1 - SPRTBETA) / SPRTALPHA);
+
+    ostringstream os;
+    os.setf(ios::fixed);
+    os.precision(2);
+    os << "Score of A vs B: " << r.wins << " - " << r.losses << " - " << r.draws << "  ["
+       << (r.wins + 0.5 * r.draws) / numGames << "] " << numGames << "\n";
+    os << "Elo difference: " << elo << " +/- " << errorMargin << "\n";
+    os << "SPRT: llr " << llr << " (" << lowerBound << ", " << upperBound << "), elo0 " << SPRTELO0
+       << " elo1 " << SPRTELO1;
+
+    if (llr >= upperBound)
+    {
+        os << " - H1 was accepted";
+        match.finished = true;
+    }
+    else if (llr <= lowerBound)
+    {
+        os << " - H0 was accepted";
+        match.finished = true;
+    }
+
+    *match.out << os.str() << endl;
+}
+
+// Function run by each thread, playing games until the match is over
+void selfPlayThread (selfPlayMatch &match)
+{
+    // Engine A is index 0 and engine B is index 1
+    unique_ptr <searchInfo> engines[2] = {unique_ptr <searchInfo> (new searchInfo), unique_ptr <searchInfo> (new searchInfo)};
+    unique_ptr <transpositionTable> tables[2] = {unique_ptr <transpositionTable> (new transpositionTable),
+                                                 unique_ptr <transpositionTable> (new transpositionTable)};
+    for (int i = 0; i < 2; i++)
+    {
+        setHashSize(match.hashMB, *tables[i]);
+        engines[i]->limits = match.limits[i];
+        engines[i]->tt = tables[i].get();
+    }
+
+    while (!match.finished)
+    {
+        int game = match.nextGame++;
+        if (game >= match.numGames)
+            return;
+
+        // Play each opening twice, swapping sides
+        const opening &o = match.openings[(game / 2) % match.openings.size()];
+        bool aIsWhite = (game % 2 == 0);
+        searchInfo *sides[2] = {engines[aIsWhite].get(), engines[!aIsWhite].get()};
+
+        string reason;
+        int result = playSelfPlayGame(o.bBoard, o.whiteMove, o.halfMoves, sides, reason);
+
+        lock_guard <mutex> guard(match.lock);
+        if (match.finished)
+            return;
+
+        if (result == DRAW)
+            match.result.draws++;
+        else if ((result == WHITEWINS) == aIsWhite)
+            match.result.wins++;
+        else
+            match.result.losses++;
+
+        *match.out << "Finished game " << game + 1 << (aIsWhite ? " (A vs B): " : " (B vs A): ")
+                   << (result == WHITEWINS ? "1-0" : result == BLACKWINS ? "0-1" : "1/2-1/2") << " {" << reason << "}\n";
+        reportScore(match);
+    }
+}
+
+// Function to play a match between two engines with different search limits, with numThreads games at once
+matchResult playMatch (const vector <string> &openings, int numGames, const searchLimits &limitsA,
+                       const searchLimits &limitsB, int numThreads, int hashMB, ostream &out)
+{
+    selfPlayMatch match;
+    match.numGames = numGames;
+    match.hashMB = hashMB;
+    match.nextGame = 0;
+    match.finished = false;
+    match.out = &out;
+
+    // Every game gets one thread, so the engines search on one thread each
+    match.limits[0] = limitsA;
+    match.limits[1] = limitsB;
+    for (int i = 0; i < 2; i++)
+    {
+        match.limits[i].threads = 1;
+        match.limits[i].splitPoints = false;
+    }
+
+    // Set up the openings, skipping any that aren't valid or are already over
+    for (unsigned int i = 0; i < openings.size(); i++)
+    {
+        opening o;
+        if (parseFen(o.bBoard, o.whiteMove, openings[i].c_str(), &o.halfMoves)
+            && getGameResult(o.bBoard, o.whiteMove) == NORESULT)
+            match.openings.push_back(o);
+        else
+            out << "Skipping opening " << i + 1 << ": " << openings[i] << endl;
+    }
+
+    if (match.openings.empty())
+        return match.result;
+
+    vector <thread> threads;
+    for (int i = 0; i < max(numThreads, 1); i++)
+        threads.push_back(thread(selfPlayThread, ref(match)));
+    for (unsigned int i = 0; i < threads.size(); i++)
+        threads[i].join();
+
+    return match.result;
+}
+
+// Function to read search limits written like "nodes=5000", "movetime=50" or "depth=6,nodes=20000"
+bool parseLimits (const string &s, searchLimits &limits)
+{
+    istringstream is(s);
+    string limit;
+    limits = searchLimits();
+
+    while (getline(is, limit, ','))
+    {
+        size_t equals = limit.find('=');
+        if (equals == string::npos)
+            return false;
+
+        string name = limit.substr(0, equals);
+        long long value = atoll(limit.c_str() + equals + 1);
+        if (value <= 0)
+            return false;
+
+        if (name == "depth")
+            limits.depth = (int)value;
+        else if (name == "nodes")
+            limits.nodes = (U64)value;
+        else if (name == "movetime")
+            limits.moveTime = (int)value;
+        else
+            return false;
+    }
+
+    // A search without any limit would never end
+    return limits.depth > 0 || limits.nodes > 0 || limits.moveTime > 0;
+}
@@ -0,0 +1,57 @@
+/// selfplay.h
+///
+/// Willie Lei
+/// Header file for selfplay.cpp
+
+#ifndef SELFPLAY_H_INCLUDED
+#define SELFPLAY_H_INCLUDED
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include "search.h"
+
+// Games longer than this many plies are adjudicated as draws
+#define MAXGAMEPLIES 400
+
+// A game is adjudicated as a win once one side is ahead by ADJUDICATEMATERIAL for ADJUDICATEPLIES plies in a row
+#define ADJUDICATEMATERIAL 700
+#define ADJUDICATEPLIES 8
+
+// After DRAWADJUDICATEPLY plies, a game is adjudicated as a draw once both engines have scored it within
+// DRAWADJUDICATESCORE of 0 for DRAWADJUDICATEPLIES plies in a row
+#define DRAWADJUDICATEPLY 80
+#define DRAWADJUDICATESCORE 10
+#define DRAWADJUDICATEPLIES 12
+
+// The match stops early once a sequential probability ratio test (SPRT) can tell whether engine A is at least
+// SPRTELO1 Elo stronger than engine B (H1) or no stronger than SPRTELO0 (H0), with false positive and false
+// negative rates of SPRTALPHA and SPRTBETA
+#define SPRTELO0 0.0
+#define SPRTELO1 5.0
+#define SPRTALPHA 0.05
+#define SPRTBETA 0.05
+
+// The results of a match, from engine A's point of view
+struct matchResult
+{
+    int wins = 0;
+    int draws = 0;
+    int losses = 0;
+};
+
+// Function to play a match between two engines with different search limits, with numThreads games at once
+// and a table of hashMB megabytes for each engine in each game
+// Each opening (a FEN) is played twice, so that each engine gets to play both sides of it
+matchResult playMatch (const vector <string> &openings, int numGames, const searchLimits &limitsA,
+                       const searchLimits &limitsB, int numThreads, int hashMB, ostream &out);
+
+// Function to read search limits written like "nodes=5000", "movetime=50" or "depth=6,nodes=20000",
+// returning false if they aren't valid
+bool parseLimits (const string &s, searchLimits &limits);
+
+// Functions to work out the Elo difference of a match and its log-likelihood ratio for the SPRT
+double getElo (const matchResult &result, double &errorMargin);
+double getLLR (const matchResult &result);
+
+#endif // SELFPLAY_H_INCLUDED
@@ -0,0 +1,333 @@
+/// split_search.cpp
+///
+/// Willie Lei
+/// Sharing the moves of a node between threads (Young Brothers Wait), deterministically.
+///
+/// A node only shares its moves once its first move has been searched on its own, so there is a bound
+/// to search the rest with (the young brothers wait for the eldest). Each of the rest becomes a task, and the
+/// threads take the tasks in order. Every task is searched with the window from the time of the split, so the
+/// moves don't depend on each other, and the results are put together in move order once they are all in, as if
+/// they were searched one after the other. A move that fails high makes the moves after it unnecessary, so their
+/// tasks are stopped and thrown away.
+///
+/// Every node far enough from the leaves is split, whether or not there are threads free, so the search is the
+/// same with any number of threads, and the number of positions searched (counting only the tasks that are used)
+/// and the result are the same every time for a search limited by depth or nodes.
+
+#include <algorithm>
+#include <chrono>
+#include "split_search.h"
+#include "move_ordering.h"
+
+using namespace std;
+
+// Function to return whether a split point is (or is under) another one
+bool isUnder (const splitPoint *sp, const splitPoint *ancestor)
+{
+    for (; sp != NULL; sp = (sp->parentTask != NULL) ? sp->parentTask->sp : NULL)
+    {
+        if (sp == ancestor)
+            return true;
+    }
+
+    return false;
+}
+
+// Function to hand out the next task of a split point that still has some, checking the split point given first
+// If under isn't NULL, only tasks under it are handed out, so a thread waiting for its split point to finish
+// only helps the threads it is waiting for. Must be called with the pool lock held.
+splitTask *takeTask (splitPool &pool, splitPoint *under)
+{
+    splitPoint *sp = NULL;
+
+    if (under != NULL && under->nextTask < under->endTask)
+        sp = under;
+
+    for (unsigned int i = 0; i < pool.active.size() && sp == NULL; i++)
+    {
+        if (pool.active[i]->nextTask < pool.active[i]->endTask && (under == NULL || isUnder(pool.active[i], under)))
+            sp = pool.active[i];
+    }
+
+    if (sp == NULL)
+        return NULL;
+
+    // Give the task a private table
+    splitTask *task = sp->tasks[sp->nextTask++].get();
+    if (pool.freeOverlays.empty())
+    {
+        pool.overlays.push_back(unique_ptr <ttOverlay> (new ttOverlay));
+        pool.freeOverlays.push_back(pool.overlays.back().get());
+    }
+    task->tt = pool.freeOverlays.back();
+    pool.freeOverlays.pop_back();
+
+    sp->running++;
+    return task;
+}
+
+// Function to take a split point to reuse (or make a new one if they are all in use)
+// Must be called with the pool lock held.
+splitPoint *newSplitPoint (splitPool &pool)
+{
+    if (pool.freeSplits.empty())
+    {
+        pool.splits.push_back(unique_ptr <splitPoint> (new splitPoint));
+        pool.freeSplits.push_back(pool.splits.back().get());
+    }
+
+    splitPoint *sp = pool.freeSplits.back();
+    pool.freeSplits.pop_back();
+    return sp;
+}
+
+// Function to give a finished split point and the private tables of its tasks back to be reused
+// Must be called with the pool lock held.
+void freeSplitPoint (splitPool &pool, splitPoint *sp)
+{
+    for (int i = 0; i < sp->nextTask; i++)
+        pool.freeOverlays.push_back(sp->tasks[i]->tt);
+
+    pool.freeSplits.push_back(sp);
+}
+
+// Function to search a task on this thread
+void runTask (splitPool &pool, splitTask &task, searchInfo &info)
+{
+    splitPoint &sp = *task.sp;
+
+    // Search the task in its own context, starting from the killer moves and history of the split point
+    splitTask *prevTask = info.task;
+    U64 prevNodes = info.nodes;
+    info.task = &task;
+    info.nodes = 0;
+    copy(&sp.killers[0][0], &sp.killers[0][0] + MAXDEPTH*2, &info.killers[0][0]);
+    copy(&sp.history[0][0][0], &sp.history[0][0][0] + 2*64*64, &info.history[0][0][0]);
+    initOverlay(*task.tt, *info.tt, (sp.parentTask != NULL) ? sp.parentTask->tt : NULL);
+
+    bitboard bBoard = sp.bBoard;
+    task.value = searchMove(bBoard, sp.moves[task.moveNum], task.moveNum, sp.depth, sp.alpha, sp.beta, sp.whiteMove,
+                            sp.height, sp.inCheck, sp.canPrune, sp.futile, info);
+    task.nodes = info.nodes;
+    bool stopped = isStopped(info);
+
+    info.task = prevTask;
+    info.nodes = prevNodes;
+
+    lock_guard <mutex> guard(pool.lock);
+    task.done = true;
+    sp.running--;
+
+    // A move that fails high makes every move after it unnecessary
+    int taskNum = task.moveNum - sp.first;
+    if (!stopped && task.value >= sp.beta && taskNum + 1 < sp.endTask)
+    {
+        for (int i = taskNum + 1; i < sp.endTask; i++)
+            sp.tasks[i]->aborted = true;
+        sp.endTask = taskNum + 1;
+    }
+
+    pool.cond.notify_all();
+}
+
+// Function run by each helper thread, which searches tasks until the search ends
+void splitWorker (splitPool *pool, searchInfo *info)
+{
+    unique_lock <mutex> guard(pool->lock);
+
+    while (!pool->done)
+    {
+        splitTask *task = takeTask(*pool, NULL);
+        if (task == NULL)
+        {
+            pool->cond.wait(guard);
+            continue;
+        }
+
+        guard.unlock();
+        runTask(*pool, *task, *info);
+        guard.lock();
+    }
+}
+
+// Function to start the helper threads for a search
+void startSplitThreads (int numThreads, searchInfo &mainInfo)
+{
+    splitPool *pool = new splitPool;
+    mainInfo.pool = pool;
+
+    for (int i = 0; i < numThreads; i++)
+    {
+        pool->infos.push_back(unique_ptr <searchInfo> (new searchInfo));
+        pool->infos.back()->limits = mainInfo.limits;
+        pool->infos.back()->tt = mainInfo.tt;
+        pool->infos.back()->mainInfo = &mainInfo;
+        pool->infos.back()->threadNum = i + 1;
+        pool->infos.back()->pool = pool;
+        pool->threads.push_back(thread(splitWorker, pool, pool->infos.back().get()));
+    }
+}
+
+// Function to stop the helper threads once the search is over
+// (the positions they searched were already counted as their tasks were finished)
+void stopSplitThreads (searchInfo &mainInfo)
+{
+    splitPool *pool = mainInfo.pool;
+
+    {
+        lock_guard <mutex> guard(pool->lock);
+        pool->done = true;
+    }
+    pool->cond.notify_all();
+
+    for (unsigned int i = 0; i < pool->threads.size(); i++)
+        pool->threads[i].join();
+
+    delete pool;
+    mainInfo.pool = NULL;
+}
+
+// Function to return whether a node this far from the leaves should share its moves
+// (this mustn't depend on whether any threads are free, or the search would depend on the timing of the threads)
+bool canSplit (int depth, const searchInfo &info)
+{
+    return info.pool != NULL && depth >= MINSPLITDEPTH;
+}
+
+// Function to add the positions searched by the tasks that are finished, in order, to the count of the thread
+// that made the split point, so the count only ever includes the same tasks. Must be called with the pool lock held.
+void countTaskNodes (splitPoint &sp, searchInfo &info)
+{
+    while (sp.counted < sp.endTask && sp.tasks[sp.counted]->done && !isStopped(info))
+    {
+        info.nodes += sp.tasks[sp.counted]->nodes;
+        sp.counted++;
+
+        // Off the split points, the count is the same every time, so the node limit can be checked
+        checkStop(info);
+    }
+}
+
+// Function to search the moves of a node from first onwards as tasks for this thread and the helper threads
+// The moves must already be in the order they should be searched in
+void searchSplit (bitboard &bBoard, plyList &moves, int first, int depth, int &alpha, int beta, bool whiteMove,
+                  int height, bool inCheck, bool canPrune, bool futile, int &bestVal, ply &bestMove, searchInfo &info)
+{
+    splitPool &pool = *info.pool;
+    unique_lock <mutex> guard(pool.lock);
+    splitPoint &sp = *newSplitPoint(pool);
+    guard.unlock();
+
+    sp.parentTask = info.task;
+    sp.bBoard = bBoard;
+    sp.moves = moves;
+    sp.first = first;
+    sp.whiteMove = whiteMove;
+    sp.depth = depth;
+    sp.alpha = alpha;
+    sp.beta = beta;
+    sp.height = height;
+    sp.inCheck = inCheck;
+    sp.canPrune = canPrune;
+    sp.futile = futile;
+    copy(&info.killers[0][0], &info.killers[0][0] + MAXDEPTH*2, &sp.killers[0][0]);
+    copy(&info.history[0][0][0], &info.history[0][0][0] + 2*64*64, &sp.history[0][0][0]);
+
+    // Set up the tasks, making more if the split point hasn't had this many before
+    sp.numTasks = moves.size - first;
+    while ((int)sp.tasks.size() < sp.numTasks)
+        sp.tasks.push_back(unique_ptr <splitTask> (new splitTask));
+
+    for (int i = 0; i < sp.numTasks; i++)
+    {
+        splitTask &task = *sp.tasks[i];
+        task.sp = &sp;
+        task.moveNum = first + i;
+        task.done = false;
+        task.aborted = false;
+        task.value = 0;
+        task.nodes = 0;
+        task.tt = NULL;
+    }
+
+    sp.nextTask = 0;
+    sp.running = 0;
+    sp.counted = 0;
+    sp.endTask = sp.numTasks;
+
+    // Let the helper threads join in
+    guard.lock();
+    pool.active.push_back(&sp);
+    pool.cond.notify_all();
+
+    // Search the tasks here as well, then help with the split points under this one until every task is finished
+    while (true)
+    {
+        countTaskNodes(sp, info);
+
+        splitTask *task = isStopped(info) ? NULL : takeTask(pool, &sp);
+        if (task != NULL)
+        {
+            guard.unlock();
+            runTask(pool, *task, info);
+            guard.lock();
+            continue;
+        }
+
+        if (sp.running == 0 && (sp.nextTask >= sp.endTask || isStopped(info)))
+            break;
+
+        // Keep checking the time while waiting
+        pool.cond.wait_for(guard, chrono::milliseconds(1));
+        checkStop(info);
+    }
+
+    countTaskNodes(sp, info);
+    pool.active.erase(find(pool.active.begin(), pool.active.end(), &sp));
+    guard.unlock();
+
+    // Go back to the killer moves and history from before the split
+    copy(&sp.killers[0][0], &sp.killers[0][0] + MAXDEPTH*2, &info.killers[0][0]);
+    copy(&sp.history[0][0][0], &sp.history[0][0][0] + 2*64*64, &info.history[0][0][0]);
+
+    // Put the results together in move order, as if the moves had been searched one after the other
+    if (!isStopped(info))
+    {
+        for (int i = 0; i < sp.endTask; i++)
+        {
+            splitTask &task = *sp.tasks[i];
+            mergeTT(*info.tt, *task.tt, getTaskTT(info));
+
+            if (task.value > bestVal)
+            {
+                bestVal = task.value;
+                bestMove = moves[task.moveNum];
+            }
+            if (task.value > alpha)
+                alpha = task.value;
+        }
+
+        // Remember the move that failed high if it was quiet
+        ply lastMove = moves[sp.tasks[sp.endTask - 1]->moveNum];
+        if (beta <= alpha && !isTactical(bBoard, lastMove))
+            updateHeuristics(info, lastMove, depth, height, whiteMove);
+    }
+
+    guard.lock();
+    freeSplitPoint(pool, &sp);
+}
+
+// Function to return whether a thread should give up its search
+bool isStopped (const searchInfo &info)
+{
+    if (info.stop.load(memory_order_relaxed))
+        return true;
+
+    for (splitTask *task = info.task; task != NULL; task = task->sp->parentTask)
+    {
+        if (task->aborted.load(memory_order_relaxed))
+            return true;
+    }
+
+    return false;
+}
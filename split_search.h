@@ -0,0 +1,119 @@
+/// split_search.h
+///
+/// Willie Lei
+/// Header file for split_search.cpp
+
+#ifndef SPLIT_SEARCH_H_INCLUDED
+#define SPLIT_SEARCH_H_INCLUDED
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <memory>
+#include <vector>
+#include <condition_variable>
+#include "search.h"
+#include "transposition_table.h"
+
+// Nodes closer to the leaves than this aren't shared, since their subtrees are too small to be worth it
+#define MINSPLITDEPTH 3
+
+struct splitPoint;
+
+// One move of a split point, which is searched as a task of its own by whichever thread takes it
+// A task starts from the same window, killer moves and history whichever thread searches it and whenever it is
+// searched, and only stores results in its own private table, so its value and the number of positions it searches
+// never depend on the timing of the threads
+struct splitTask
+{
+    splitPoint *sp;
+    int moveNum;
+
+    // Set (under the pool lock) once the task has been searched
+    bool done = false;
+
+    // Set if a move before this one failed high, so this one is no longer needed
+    atomic <bool> aborted {false};
+
+    // The value of the move, the positions searched for it, and the table it stores its results in
+    // (taken from the pool when the task is handed out, and given back once the split point is finished)
+    int value = 0;
+    U64 nodes = 0;
+    ttOverlay *tt = NULL;
+};
+
+// A node whose moves after the first are searched as tasks by any threads that are free
+struct splitPoint
+{
+    // The task the node is being searched in (NULL if it isn't under another split point)
+    splitTask *parentTask;
+
+    // The position, the moves (the ones from first onwards are the tasks) and the window the tasks are searched with
+    bitboard bBoard;
+    plyList moves;
+    int first;
+    bool whiteMove;
+    int depth;
+    int alpha;
+    int beta;
+    int height;
+    bool inCheck;
+    bool canPrune;
+    bool futile;
+
+    // The killer moves and history of the thread that made the split point, which every task starts from
+    ply killers[MAXDEPTH][2];
+    int history[2][64][64];
+
+    // The tasks (only the first numTasks are used, since split points are reused), and (guarded by the pool lock)
+    // the next one to hand out, the number being searched, the number whose positions have been added to the count
+    // so far, and the end of the tasks that are needed (just after the first one that failed high)
+    vector <unique_ptr <splitTask>> tasks;
+    int numTasks;
+    int nextTask;
+    int running;
+    int counted;
+    int endTask;
+};
+
+// The helper threads of a search that uses split points, and the split points that have tasks to hand out
+// Every search has its own pool, so several searches can share moves at the same time
+// Split points and the private tables of tasks are kept once they are made, and reused whenever one is finished
+struct splitPool
+{
+    vector <thread> threads;
+    vector <unique_ptr <searchInfo>> infos;
+    vector <splitPoint*> active;
+    vector <unique_ptr <splitPoint>> splits;
+    vector <splitPoint*> freeSplits;
+    vector <unique_ptr <ttOverlay>> overlays;
+    vector <ttOverlay*> freeOverlays;
+    mutex lock;
+    condition_variable cond;
+    bool done = false;
+};
+
+// Functions to start and stop the helper threads of a search
+void startSplitThreads (int numThreads, searchInfo &mainInfo);
+void stopSplitThreads (searchInfo &mainInfo);
+
+// Function to return whether a node this far from the leaves should share its moves
+bool canSplit (int depth, const searchInfo &info);
+
+// Function to search the moves of a node from first onwards as tasks for this thread and the helper threads,
+// updating alpha, the best value and the best move
+// (canPrune and futile are passed on to searchMove for every move)
+void searchSplit (bitboard &bBoard, plyList &moves, int first, int depth, int &alpha, int beta, bool whiteMove,
+                  int height, bool inCheck, bool canPrune, bool futile, int &bestVal, ply &bestMove, searchInfo &info);
+
+// Function to return whether a thread should give up its search, because the search was stopped
+// or a task it is under is no longer needed
+bool isStopped (const searchInfo &info);
+
+// Function to return the private table of the task a thread is searching (NULL if it isn't searching a task)
+inline ttOverlay *getTaskTT (const searchInfo &info)
+{
+    return (info.task != NULL) ? info.task->tt : NULL;
+}
+
+#endif // SPLIT_SEARCH_H_INCLUDED
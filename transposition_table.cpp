@@ -0,0 +1,229 @@
+/// transposition_table.cpp
+///
+/// Willie Lei
+/// Transposition table that remembers the results of searching positions.
+
+#include <algorithm>
+#include "transposition_table.h"
+#include "search.h"
+
+using namespace std;
+
+// The table used by every search that isn't given one of its own
+transpositionTable ttTable;
+
+// Function to set the size of a table in megabytes, which empties it
+void setHashSize (int hashMB, transpositionTable &table)
+{
+    size_t numBuckets = 1;
+
+    // Use the largest power of 2 that fits so the index can be taken with a mask
+    while (numBuckets * 2 * sizeof(ttBucket) <= (size_t)max(hashMB, 1) * 1024 * 1024)
+        numBuckets *= 2;
+
+    vector <ttBucket> newTable(numBuckets);
+    table.buckets.swap(newTable);
+    clearTT(table);
+}
+
+// Function to empty a table
+void clearTT (transpositionTable &table)
+{
+    for (unsigned int i = 0; i < table.buckets.size(); i++)
+    {
+        for (int j = 0; j < 4; j++)
+        {
+            table.buckets[i].entries[j].keyXorData.store(0, memory_order_relaxed);
+            table.buckets[i].entries[j].data.store(0, memory_order_relaxed);
+        }
+    }
+    table.age = 0;
+}
+
+// Function to start a new search, so that entries from older searches are replaced first
+void newSearchTT (transpositionTable &table)
+{
+    // Make the table before any search threads start, so they never race to make it
+    if (table.buckets.size() == 0)
+        setHashSize(16, table);
+
+    table.age = (table.age + 1) & 63;
+}
+
+// Function to unpack the data of an entry
+inline void unpackData (U64 d, ttData &data)
+{
+    data.move = (ply)(d & 0xFFFF);
+    data.score = (int)(unsigned int)((d >> 16) & 0xFFFFFFFF);
+    data.depth = (int)((d >> 48) & 255);
+    data.bound = (int)((d >> 56) & 3);
+}
+
+// Function to find the data of a position in the private tables or the shared table
+bool probeData (transpositionTable &table, U64 key, ttData &data, const ttOverlay *overlay)
+{
+    // The private tables of the task being searched and the tasks it is under have the newest results
+    for (; overlay != NULL; overlay = overlay->parent)
+    {
+        size_t bucket = (key & (overlay->entries.size()/4 - 1)) * 4;
+        for (size_t i = bucket; i < bucket + 4; i++)
+        {
+            if (overlay->entries[i].first == key && overlay->entries[i].second != 0)
+            {
+                unpackData(overlay->entries[i].second, data);
+                return true;
+            }
+        }
+    }
+
+    if (table.buckets.size() == 0)
+        setHashSize(16, table);
+
+    ttBucket &bucket = table.buckets[key & (table.buckets.size() - 1)];
+
+    for (int i = 0; i < 4; i++)
+    {
+        U64 d = bucket.entries[i].data.load(memory_order_relaxed);
+
+        if ((bucket.entries[i].keyXorData.load(memory_order_relaxed) ^ d) == key && d != 0)
+        {
+            unpackData(d, data);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// Function to look up a position, returning whether it was found
+bool probeTT (transpositionTable &table, U64 key, ttData &data, int height, const ttOverlay *overlay)
+{
+    if (!probeData(table, key, data, overlay))
+        return false;
+
+    // Make a mate score relative to the root again
+    if (data.score >= MINMATESCORE)
+        data.score -= height;
+    else if (data.score <= -MINMATESCORE)
+        data.score += height;
+
+    return true;
+}
+
+// Function to store the packed data of a position in a private table
+void storeOverlayData (U64 key, U64 data, ttOverlay &overlay)
+{
+    size_t bucket = (key & (overlay.entries.size()/4 - 1)) * 4;
+    size_t replace = bucket;
+    int worstDepth = 256;
+
+    // Overwrite the same position if it is there, otherwise replace the entry with the lowest depth
+    // (every entry is from the same search)
+    for (size_t i = bucket; i < bucket + 4; i++)
+    {
+        U64 oldData = overlay.entries[i].second;
+        if (overlay.entries[i].first == key || oldData == 0)
+        {
+            // Keep the old best move if there isn't a new one
+            if ((data & 0xFFFF) == 0 && oldData != 0)
+                data |= oldData & 0xFFFF;
+
+            replace = i;
+            break;
+        }
+
+        if ((int)((oldData >> 48) & 255) < worstDepth)
+        {
+            worstDepth = (int)((oldData >> 48) & 255);
+            replace = i;
+        }
+    }
+
+    overlay.entries[replace] = make_pair(key, data);
+}
+
+// Function to store the packed data of a position in the shared table
+void storeTableData (transpositionTable &table, U64 key, U64 data)
+{
+    if (table.buckets.size() == 0)
+        setHashSize(16, table);
+
+    ttBucket &bucket = table.buckets[key & (table.buckets.size() - 1)];
+    ttEntry *replace = &bucket.entries[0];
+    int worstVal = 1000000;
+
+    // Overwrite the same position if it is there, otherwise replace the entry
+    // with the lowest depth, counting entries from older searches as much shallower
+    for (int i = 0; i < 4; i++)
+    {
+        ttEntry &entry = bucket.entries[i];
+        U64 oldData = entry.data.load(memory_order_relaxed);
+        U64 entryKey = entry.keyXorData.load(memory_order_relaxed) ^ oldData;
+
+        if (entryKey == key || oldData == 0)
+        {
+            // Keep the old best move if there isn't a new one
+            if ((data & 0xFFFF) == 0 && entryKey == key)
+                data |= oldData & 0xFFFF;
+
+            replace = &entry;
+            break;
+        }
+
+        int entryAge = (int)(oldData >> 58);
+        int entryVal = (int)((oldData >> 48) & 255) - 8 * ((table.age - entryAge) & 63);
+
+        if (entryVal < worstVal)
+        {
+            worstVal = entryVal;
+            replace = &entry;
+        }
+    }
+
+    replace->keyXorData.store(key ^ data, memory_order_relaxed);
+    replace->data.store(data, memory_order_relaxed);
+}
+
+// Function to store the result of searching a position
+void storeTT (transpositionTable &table, U64 key, ply move, int score, int depth, int bound, int height,
+              ttOverlay *overlay)
+{
+    // Store a mate score as the distance to the mate from this position, so it is right wherever the position is found
+    if (score >= MINMATESCORE)
+        score += height;
+    else if (score <= -MINMATESCORE)
+        score -= height;
+
+    U64 data = (U64)move | ((U64)(unsigned int)score << 16) | ((U64)(depth & 255) << 48)
+             | ((U64)bound << 56) | ((U64)table.age << 58);
+
+    if (overlay != NULL)
+        storeOverlayData(key, data, *overlay);
+    else
+        storeTableData(table, key, data);
+}
+
+// Function to empty a private table, sizing it for the shared table it goes with, and set the table it is under
+void initOverlay (ttOverlay &overlay, const transpositionTable &table, const ttOverlay *parent)
+{
+    size_t numBuckets = max(table.buckets.size() / OVERLAYFRACTION, (size_t)MINOVERLAYBUCKETS);
+
+    // Reuses the memory of the table if it was used before
+    overlay.entries.assign(numBuckets * 4, make_pair((U64)0, (U64)0));
+    overlay.parent = parent;
+}
+
+// Function to copy the results in a private table into another one (or into the shared table if to is NULL)
+void mergeTT (transpositionTable &table, const ttOverlay &from, ttOverlay *to)
+{
+    for (unsigned int i = 0; i < from.entries.size(); i++)
+    {
+        if (from.entries[i].second == 0)
+            continue;
+
+        if (to != NULL)
+            storeOverlayData(from.entries[i].first, from.entries[i].second, *to);
+        else
+            storeTableData(table, from.entries[i].first, from.entries[i].second);
+    }
+}
@@ -0,0 +1,90 @@
+/// transposition_table.h
+///
+/// Willie Lei
+/// Header file for transposition_table.cpp
+
+#ifndef TRANSPOSITION_TABLE_H_INCLUDED
+#define TRANSPOSITION_TABLE_H_INCLUDED
+
+#include <atomic>
+#include <vector>
+#include "legal_moves.h"
+
+// Types of scores stored in the table
+// (an upper bound means the search failed low, a lower bound means it failed high)
+enum {NOBOUND, UPPERBOUND, LOWERBOUND, EXACTBOUND};
+
+// An entry in the transposition table
+// The data holds the best move (bits 0-15), the score (bits 16-47), the depth (bits 48-55),
+// the type of score (bits 56-57) and the age of the search that stored it (bits 58-63)
+// The key is stored XORed with the data, so an entry torn by two threads writing at once fails the key check
+// and the table can be shared by every search thread without locking
+struct ttEntry
+{
+    atomic <U64> keyXorData;
+    atomic <U64> data;
+};
+
+// Four entries fill a 64-byte cache line, so a probe only ever touches one line
+struct alignas(64) ttBucket
+{
+    ttEntry entries[4];
+};
+
+// What was found in the table for a position
+struct ttData
+{
+    ply move;
+    int score;
+    int depth;
+    int bound;
+};
+
+// A private table that one task of a split point search stores its results in (see split_search.h)
+// Looking up a position checks the task's table, then the tables of the tasks it is under, then the shared table,
+// and the results only reach the shared table (in a fixed order) once the split point is finished, so what a task
+// finds in the tables never depends on what the other threads happen to have stored so far
+// It is a fixed size, 1/OVERLAYFRACTION of the shared table (but at least MINOVERLAYBUCKETS buckets), replacing
+// the shallowest entry when a bucket is full, so a task can't use more memory however long it is searched for,
+// and the tables of all the tasks in progress only add a small part to the Hash size
+#define OVERLAYFRACTION 4096
+#define MINOVERLAYBUCKETS 16
+
+struct ttOverlay
+{
+    const ttOverlay *parent = NULL;
+
+    // The key and data of each entry, four to a bucket (an entry with no data is empty)
+    vector <pair <U64, U64>> entries;
+};
+
+// A table (a power of 2 buckets) and the age of the current search
+// (atomic, since a table can be shared by several independent searches)
+struct transpositionTable
+{
+    vector <ttBucket> buckets;
+    atomic <int> age {0};
+};
+
+// The table used by every search that isn't given one of its own
+extern transpositionTable ttTable;
+
+// Functions to set up and manage a table
+void setHashSize (int hashMB, transpositionTable &table = ttTable);
+void clearTT (transpositionTable &table = ttTable);
+void newSearchTT (transpositionTable &table = ttTable);
+
+// Functions to look up and store positions (in a private table instead of the shared one if one is given)
+// Mate scores are stored as the distance to the mate from the position, not from the root,
+// so height (the distance of the position from the root) is needed to convert them
+bool probeTT (transpositionTable &table, U64 key, ttData &data, int height, const ttOverlay *overlay = NULL);
+void storeTT (transpositionTable &table, U64 key, ply move, int score, int depth, int bound, int height,
+              ttOverlay *overlay = NULL);
+
+// Function to empty a private table, sizing it for the shared table it goes with, and set the table it is under
+void initOverlay (ttOverlay &overlay, const transpositionTable &table, const ttOverlay *parent);
+
+// Function to copy the results in a private table into another one (or into the shared table if to is NULL)
+void mergeTT (transpositionTable &table, const ttOverlay &from, ttOverlay *to);
+
+#endif // TRANSPOSITION_TABLE_H_INCLUDED
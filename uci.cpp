@@ -0,0 +1,268 @@
+/// uci.cpp
+///
+/// Willie Lei
+/// Universal Chess Interface (UCI) front end, so the engine can be run by chess GUIs and tournament managers.
+///
+/// Commands are read on the main thread and the search runs on a thread of its own,
+/// so commands like stop and isready are answered while it is searching.
+
+#include <iostream>
+#include <sstream>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <cstdlib>
+#include "uci.h"
+#include "transposition_table.h"
+#include "fen.h"
+#include "book.h"
+
+using namespace std;
+
+// The position to search from and the side to move
+bitboard uciBoard;
+bool uciWhiteMove = true;
+
+// The search, the thread it runs on, and whether it has finished
+searchInfo uciInfo;
+thread searchThread;
+atomic <bool> searchDone(true);
+
+// Set while searching with go infinite, since the best move must not be sent until the GUI says to stop
+atomic <bool> infiniteSearch(false);
+
+// Lock so that lines from the search thread and the main thread don't get mixed together
+mutex outputLock;
+
+// Function to send a line to the GUI
+void sendLine (const string &line)
+{
+    lock_guard <mutex> guard(outputLock);
+    cout << line << endl;
+}
+
+// Function to turn a move in UCI notation into a ply, returning 0 if it isn't legal
+ply stringToPly (const bitboard &bBoard, bool whiteMove, const string &s)
+{
+    plyList legalMoves;
+    getLegalMoves(bBoard, whiteMove, legalMoves);
+
+    for (int i = 0; i < legalMoves.size; i++)
+    {
+        if (plyToString(legalMoves[i]) == s)
+            return legalMoves[i];
+    }
+
+    return 0;
+}
+
+// Function to report a completed iteration to the GUI
+void reportIteration (const bitboard &bBoard, bool whiteMove, const searchInfo &info)
+{
+    int ms = (int)chrono::duration_cast <chrono::milliseconds> (chrono::steady_clock::now() - info.startTime).count();
+    plyList pv;
+    getPV(bBoard, whiteMove, info.bestMove, info.completedDepth, pv, *info.tt);
+
+    ostringstream os;
+    os << "info depth " << info.completedDepth;
+
+    if (mateMoves(info.score) != 0)
+        os << " score mate " << mateMoves(info.score);
+    else
+        os << " score cp " << info.score;
+
+    os << " nodes " << info.nodes << " nps " << info.nodes * 1000 / max(ms, 1) << " time " << ms << " pv";
+    for (int i = 0; i < pv.size; i++)
+        os << " " << plyToString(pv[i]);
+
+    sendLine(os.str());
+}
+
+// Function run on the search thread, which sends the best move once the search is over
+void runSearch (bitboard bBoard, bool whiteMove)
+{
+    ply move = findBestMove(bBoard, whiteMove, uciInfo);
+
+    while (infiniteSearch)
+        this_thread::sleep_for(chrono::milliseconds(1));
+
+    sendLine("bestmove " + (move != 0 ? plyToString(move) : string("0000")));
+    searchDone = true;
+}
+
+// Function to stop the search (if there is one) and wait for it to send its best move
+void stopSearch ()
+{
+    infiniteSearch = false;
+
+    // Keep setting the stop flag, in case the search only just started and cleared it
+    while (!searchDone)
+    {
+        uciInfo.stop = true;
+        this_thread::sleep_for(chrono::milliseconds(1));
+    }
+
+    if (searchThread.joinable())
+        searchThread.join();
+}
+
+// Function to set up the position given by a position command
+// Usage: position startpos|fen <fen> [moves <move1> ... <movei>]
+void setPosition (istringstream &is)
+{
+    string token, fen;
+    is >> token;
+
+    if (token == "startpos")
+        fen = STARTFEN;
+    else if (token == "fen")
+    {
+        while (is >> token && token != "moves")
+            fen += token + " ";
+    }
+
+    // Leave the position alone if the FEN isn't valid
+    if (!parseFen(uciBoard, uciWhiteMove, fen.c_str()))
+        return;
+
+    // Play the moves that follow (stopping at the first illegal one)
+    while (is >> token)
+    {
+        if (token == "moves")
+            continue;
+
+        ply move = stringToPly(uciBoard, uciWhiteMove, token);
+        if (move == 0)
+            break;
+
+        undo u;
+        makeMove(uciBoard, move, u);
+        uciWhiteMove = !uciWhiteMove;
+    }
+}
+
+// Function to start searching the current position with the limits given by a go command
+// Usage: go [depth <d>] [nodes <n>] [movetime <ms>] [wtime <ms>] [btime <ms>] [winc <ms>] [binc <ms>] [movestogo <n>] [infinite]
+void startSearch (istringstream &is)
+{
+    stopSearch();
+
+    string token;
+    int timeLeft[2] = {-1, -1}, inc[2] = {0, 0};
+    int movesToGo = DEFAULTMOVESTOGO;
+    bool infinite = false;
+
+    uciInfo.limits.depth = 0;
+    uciInfo.limits.nodes = 0;
+    uciInfo.limits.moveTime = 0;
+
+    while (is >> token)
+    {
+        if (token == "depth")
+            is >> uciInfo.limits.depth;
+        else if (token == "nodes")
+            is >> uciInfo.limits.nodes;
+        else if (token == "movetime")
+            is >> uciInfo.limits.moveTime;
+        else if (token == "wtime")
+            is >> timeLeft[1];
+        else if (token == "btime")
+            is >> timeLeft[0];
+        else if (token == "winc")
+            is >> inc[1];
+        else if (token == "binc")
+            is >> inc[0];
+        else if (token == "movestogo")
+            is >> movesToGo;
+        else if (token == "infinite")
+            infinite = true;
+    }
+
+    // Work out how long to spend on the move from the clock of the side to move
+    if (uciInfo.limits.moveTime == 0 && timeLeft[uciWhiteMove] >= 0)
+    {
+        int time = timeLeft[uciWhiteMove];
+        int moveTime = time / max(movesToGo, 1) + inc[uciWhiteMove] * 3 / 4;
+        uciInfo.limits.moveTime = max(1, min(moveTime, time - MOVEOVERHEAD));
+    }
+
+    infiniteSearch = infinite;
+    searchDone = false;
+    searchThread = thread(runSearch, uciBoard, uciWhiteMove);
+}
+
+// Function to change an option given by a setoption command
+// Usage: setoption name <id> [value <x>]
+// Any search is stopped first, since it could still be using the table, the book or the limits
+void setOption (istringstream &is)
+{
+    string token, name, value;
+
+    stopSearch();
+
+    is >> token;
+    while (is >> token && token != "value")
+        name += (name.empty() ? "" : " ") + token;
+    while (is >> token)
+        value += (value.empty() ? "" : " ") + token;
+
+    if (name == "Hash")
+        setHashSize(max(atoi(value.c_str()), 1));
+    else if (name == "Threads")
+        uciInfo.limits.threads = max(atoi(value.c_str()), 1);
+    else if (name == "SplitPoints")
+        uciInfo.limits.splitPoints = (value == "true");
+    else if (name == "BookFile")
+    {
+        if (value.empty() || value == "<empty>")
+            closeBook();
+        else if (!openBook(value))
+            sendLine("info string Could not open book " + value);
+    }
+}
+
+// Function to read UCI commands from the standard input until told to quit
+void uciLoop ()
+{
+    string line, command;
+
+    parseFen(uciBoard, uciWhiteMove, STARTFEN);
+    uciInfo.onIteration = reportIteration;
+
+    while (getline(cin, line))
+    {
+        istringstream is(line);
+        command.clear();
+        is >> command;
+
+        if (command == "uci")
+        {
+            sendLine("id name " ENGINENAME);
+            sendLine("id author " ENGINEAUTHOR);
+            sendLine("option name Hash type spin default 16 min 1 max 65536");
+            sendLine("option name Threads type spin default 1 min 1 max 256");
+            sendLine("option name SplitPoints type check default false");
+            sendLine("option name BookFile type string default <empty>");
+            sendLine("uciok");
+        }
+        else if (command == "isready")
+            sendLine("readyok");
+        else if (command == "setoption")
+            setOption(is);
+        else if (command == "ucinewgame")
+        {
+            stopSearch();
+            clearTT();
+        }
+        else if (command == "position")
+            setPosition(is);
+        else if (command == "go")
+            startSearch(is);
+        else if (command == "stop")
+            stopSearch();
+        else if (command == "quit")
+            break;
+    }
+
+    stopSearch();
+}
@@ -0,0 +1,27 @@
+/// uci.h
+///
+/// Willie Lei
+/// Header file for uci.cpp
+
+#ifndef UCI_H_INCLUDED
+#define UCI_H_INCLUDED
+
+#include <string>
+#include "search.h"
+
+#define ENGINENAME "Minimax Chess Engine"
+#define ENGINEAUTHOR "Willie Lei"
+
+// With a clock, a move gets the time left divided by the moves left until the next time control
+// (DEFAULTMOVESTOGO if it isn't given) plus most of the increment, keeping MOVEOVERHEAD milliseconds
+// back for the time it takes to send the move
+#define DEFAULTMOVESTOGO 30
+#define MOVEOVERHEAD 30
+
+// Function to read UCI commands from the standard input until told to quit
+void uciLoop ();
+
+// Function to turn a move in UCI notation (e.g. e2e4 or e7e8q) into a ply, returning 0 if it isn't legal
+ply stringToPly (const bitboard &bBoard, bool whiteMove, const string &s);
+
+#endif // UCI_H_INCLUDED
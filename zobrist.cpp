@@ -0,0 +1,48 @@
+/// zobrist.cpp
+///
+/// Willie Lei
+/// Zobrist hash keys used to identify positions in hash tables.
+
+#include "zobrist.h"
+
+using namespace std;
+
+// Function to calculate the hash key of a position from scratch
+U64 calcZobristKey (const bitboard &bBoard, bool whiteMove)
+{
+    U64 key = 0;
+
+    // Add the number of every piece on its square
+    for (int piece = 0; piece < 12; piece++)
+    {
+        U64 squares = bBoard.*pieceBoards[piece];
+        while (squares)
+            key ^= zobrist.pieces[piece][popSquare(squares)];
+    }
+
+    // Add the side to move, the castling rights and any en passant column
+    if (whiteMove)
+        key ^= zobrist.whiteMove;
+    key ^= getCastlingKey(bBoard);
+    if (getEnPassantCol(bBoard) >= 0)
+        key ^= zobrist.enPassant[getEnPassantCol(bBoard)];
+
+    return key;
+}
+
+// Function to return the part of the hash key for the castling rights
+U64 getCastlingKey (const bitboard &bBoard)
+{
+    U64 key = 0;
+
+    if (bBoard.wQueenSide)
+        key ^= zobrist.castling[0];
+    if (bBoard.wKingSide)
+        key ^= zobrist.castling[1];
+    if (bBoard.bQueenSide)
+        key ^= zobrist.castling[2];
+    if (bBoard.bKingSide)
+        key ^= zobrist.castling[3];
+
+    return key;
+}
@@ -0,0 +1,65 @@
+/// zobrist.h
+///
+/// Willie Lei
+/// Header file for zobrist.cpp
+
+#ifndef ZOBRIST_H_INCLUDED
+#define ZOBRIST_H_INCLUDED
+
+#include "legal_moves.h"
+
+// Struct holding the random numbers that are combined to make the hash key of a position
+struct zobristKeys
+{
+    // One number for each type of piece on each square (in the same order as pieceBoards)
+    U64 pieces[12][64];
+
+    // Number included when it is white's move
+    U64 whiteMove;
+
+    // Numbers for white queenside, white kingside, black queenside and black kingside castling
+    U64 castling[4];
+
+    // Numbers for the column of a pawn that just moved 2 squares (and could be captured en passant)
+    U64 enPassant[8];
+};
+
+// Function to return the next number from a SplitMix64 random number generator
+constexpr U64 splitMix64 (U64 &state)
+{
+    state += 0x9E3779B97F4A7C15ULL;
+    U64 z = state;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+// Function to generate all the random numbers (at compile time, so every run uses the same keys)
+constexpr zobristKeys makeZobristKeys ()
+{
+    zobristKeys keys {};
+    U64 state = 20160101;
+
+    for (int piece = 0; piece < 12; piece++)
+        for (int square = 0; square < 64; square++)
+            keys.pieces[piece][square] = splitMix64(state);
+
+    keys.whiteMove = splitMix64(state);
+
+    for (int i = 0; i < 4; i++)
+        keys.castling[i] = splitMix64(state);
+    for (int i = 0; i < 8; i++)
+        keys.enPassant[i] = splitMix64(state);
+
+    return keys;
+}
+
+constexpr zobristKeys zobrist = makeZobristKeys();
+
+// Function to calculate the hash key of a position from scratch (makeMove keeps bitboard::key up to date after that)
+U64 calcZobristKey (const bitboard &bBoard, bool whiteMove);
+
+// Function to return the part of the hash key for the castling rights
+U64 getCastlingKey (const bitboard &bBoard);
+
+#endif // ZOBRIST_H_INCLUDED